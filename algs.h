@@ -4,69 +4,155 @@
 /*---- GLOBAL FLAGS --------------------------------*/
 bool ENABLE_VISUALIZATION = true;	/* set to false to disable visualization output */
 
-/*---- FORWARD DECLARATIONS ------------------------*/
-void sample_show(SAMPLES * s, int u, int v, int t);
-
 /*---- SORT SAMPLES HANDLERS ---------------------*/
+void sample_reset(SAMPLES * s) {
+	/* clears counters and markers, keeps the values */
+	s->comparisons = 0;
+	s->swaps = 0;
+	s->steals = 0;
+	s->depth = 0;
+	s->aux = s->moved = 0;
+	s->sorted_until = -1;
+	s->pivot = -1;
+	s->lo = s->hi = -1;
+	for (int r = 0; r < REGION_COUNT; r++)
+		s->region[r].lo = s->region[r].hi = -1;
+	for (int k = 0; k < HW_COUNTERS; k++)
+		s->hw[k] = -1;
+	for (int k = 0; k < LOC_COUNTERS; k++)
+		s->loc[k] = 0;
+	for (int k = 0; k < CACHE_COUNTERS; k++)
+		s->cache[k] = 0;
+}
+
+bool sample_alloc(SAMPLES * s) {
+	/* one aligned block holding SAMPLE_SIZE values */
+	s->data = (int *) mem_alloc((size_t) SAMPLE_SIZE * sizeof(int), USE_HUGE_PAGES);
+	s->max = 0;
+	sample_reset(s);
+	return s->data != NULL;
+}
+
+void sample_free(SAMPLES * s) {
+	mem_free(s->data);
+	s->data = NULL;
+}
+
+void sample_copy(SAMPLES * dst, const SAMPLES * src) {
+	/* deep copy, dst must already be allocated */
+	int * data = dst->data;
+	*dst = *src;
+	dst->data = data;
+	memcpy(dst->data, src->data, (size_t) SAMPLE_SIZE * sizeof(int));
+}
+
 void sample_swap(SAMPLES * s, int a, int b) {
 	int t = s->data[a];
 	s->data[a] = s->data[b];
 	s->data[b] = t;
 	s->swaps++;	/* track swap count */
+	event_emit(EV_SWAP, a, b, 0);
+}
+
+/*---- OPERATION REPORTING -----------------*/
+void sample_compared(SAMPLES * s, int a, int b) {
+	s->comparisons++;
+	event_emit(EV_COMPARE, a, b, 0);
+}
+
+void sample_write(SAMPLES * s, int i, int v) {
+	/* a store that counts as a swap, like shifting an element */
+	s->data[i] = v;
+	s->swaps++;
+	event_emit(EV_WRITE, i, v, EV_COUNTED);
+}
+
+void sample_place(SAMPLES * s, int i, int v) {
+	/* a store that is not counted, like dropping a saved key */
+	s->data[i] = v;
+	event_emit(EV_WRITE, i, v, 0);
+}
+
+void sample_moved(SAMPLES * s, int i, int slot) {
+	/* element i was copied into slot of the scratch memory */
+	s->swaps++;
+	event_emit(EV_MOVE, i, slot, 0);
+}
+
+void sample_accessed(SAMPLES * s, int i, int flags) {
+	/* a load or store no other event reports, EV_IN_SCRATCH for slot i
+	   of the scratch memory */
+	(void) s;
+	event_emit(EV_ACCESS, i, 0, flags);
+}
+
+void sample_sorted(SAMPLES * s, int i) {
+	s->sorted_until = i;
+	event_emit(EV_SORTED, i, 0, 0);
+}
+
+void sample_pivot(SAMPLES * s, int i) {
+	s->pivot = i;
+	event_emit(EV_PIVOT, i, 0, 0);
+}
+
+void sample_bounds(SAMPLES * s, int lo, int hi) {
+	s->lo = lo;
+	s->hi = hi;
+	event_emit(EV_BOUNDS, lo, hi, 0);
+}
+
+void sample_depth(SAMPLES * s, int depth) {
+	/* records a new deepest recursion level */
+	if (depth <= s->depth) return;
+	s->depth = depth;
+	event_emit(EV_DEPTH, depth, 0, 0);
+}
+
+void sample_aux(SAMPLES * s, int n) {
+	/* n samples of scratch memory are in use */
+	long bytes = (long) n * sizeof(int);
+	if (bytes > s->aux) s->aux = bytes;
+	event_emit(EV_AUX, n, 0, 0);
+}
+
+void sample_copied(SAMPLES * s, int n) {
+	/* n samples were copied in bulk between buffers */
+	s->moved += (long) n * sizeof(int);
+	event_emit(EV_COPY, n, 0, 0);
+}
+
+void sample_step(SAMPLES * s, int u, int v, int t) {
+	(void) s;
+	event_emit(EV_STEP, u, v, t);
+}
+
+void sample_flash(SAMPLES * s, int u, int v, int t) {
+	(void) s;
+	event_emit(EV_FLASH, u, v, t);
+}
+
+void sample_frame(SAMPLES * s, int u, int v, int t) {
+	(void) s;
+	event_emit(EV_FRAME, u, v, t);
 }
 
 void sample_swap_animated(SAMPLES * s, int a, int b, int u, int v, int t) {
 	/* Animated swap with smooth transition */
-	if (!SMOOTH_TRANSITIONS || !ENABLE_VISUALIZATION) {
+	if (!SMOOTH_TRANSITIONS) {
 		sample_swap(s, a, b);
 		return;
 	}
 	
 	/* Show highlighting before swap */
-	for (int frame = 0; frame < TRANSITION_FRAMES; frame++) {
-		sample_show(s, a, b, t);
-		mssleep(SAMPLE_SPEED / (TRANSITION_FRAMES + 1));
-	}
+	for (int frame = 0; frame < TRANSITION_FRAMES; frame++)
+		sample_flash(s, a, b, t);
 	
 	/* Perform actual swap */
 	sample_swap(s, a, b);
 	
 	/* Show result with flash effect */
-	sample_show(s, a, b, t);
-	mssleep(SAMPLE_SPEED / (TRANSITION_FRAMES + 1));
-}
-
-int sample_height(SAMPLES * s, int i) {
-	return 	(s->max-s->data[i]);
-}
-
-void sample_generate_ascending(SAMPLES * s) {
-	int i;
-	for (i = 0; i < SAMPLE_SIZE; i++) s->data[i] = i+1;
-	s->max = i;
-	s->comparisons = 0;
-	s->swaps = 0;
-	s->sorted_until = -1;
-}
-
-void sample_generate_descending(SAMPLES * s) {
-	int i;
-	for (i = 0; i < SAMPLE_SIZE; i++) s->data[i] = SAMPLE_SIZE-i;
-	s->max = i;
-	s->comparisons = 0;
-	s->swaps = 0;
-	s->sorted_until = -1;
-}
-
-void sample_generate_random(SAMPLES * s) {
-	int i;
-	sample_generate_ascending(s);
-	for (i = 0; i < SAMPLE_SIZE; i++)	/* shuffling */
-		sample_swap(s, rand() % SAMPLE_SIZE, rand() % SAMPLE_SIZE);
-	/* Reset stats after shuffle */
-	s->comparisons = 0;
-	s->swaps = 0;
-	s->sorted_until = -1;
+	sample_flash(s, a, b, t);
 }
 
 void sample_validate(SAMPLES * s) {
@@ -79,67 +165,6 @@ void sample_validate(SAMPLES * s) {
 	}
 }
 
-bool sample_generate(SAMPLES * s) {
-	char choice;
-	int selected = 0;
-	const char* items[] = {
-		"A. Randomized",
-		"B. Ascending",
-		"C. Descending",
-		"",
-		"D. Back"
-	};
-	
-	while (1) {
-		clear();
-		printf(VT_COLOR(220)"GENERATE NEW SAMPLES\n");
-		printf(VT_RESET"--------------------\n");
-		
-		for (int i = 0; i < 5; i++) {
-			if (items[i][0] == '\0') {
-				printf(VT_RESET"--------------------\n");
-			} else {
-				if (i == selected) {
-					printf(VT_ATTR(7)"%-20s"VT_DEFAULTATTR"\n", items[i]);
-				} else {
-					printf(VT_COLOR(150)"%c"VT_RESET"%s\n", items[i][0], items[i] + 1);
-				}
-			}
-		}
-		
-		printf(VT_RESET"\nUse "VT_ATTR(33)"UP/DOWN"VT_DEFAULTATTR" arrows or "VT_ATTR(33)"A-D"VT_DEFAULTATTR", press "VT_ATTR(33)"ENTER"VT_DEFAULTATTR" to select\n");
-		fflush(stdout);
-		
-		int ch = getch_arrow();
-		
-		/* Handle arrow keys */
-		if (ch == 'U') {  /* Up arrow */
-			do {
-				selected = (selected - 1 + 5) % 5;
-			} while (selected == 3);  /* Skip separator */
-			continue;
-		} else if (ch == 'D') {  /* Down arrow */
-			do {
-				selected = (selected + 1) % 5;
-			} while (selected == 3);  /* Skip separator */
-			continue;
-		} else if (ch == '\n' || ch == '\r') {  /* Enter */
-			const char mapping[] = "ABCD";
-			choice = (selected == 4) ? 'D' : mapping[selected];
-		} else {
-			choice = toupper(ch & 0xFF);
-		}
-		
-		switch (choice) {
-		case 'A': sample_generate_random(s); return true;
-		case 'B': sample_generate_ascending(s); return true;
-		case 'C': sample_generate_descending(s); return true;
-		case 'D': return false;
-		default: continue;
-		}
-	}
-}
-
 bool sample_is_sorted(SAMPLES * s) {
 	for (int i = 0; i < SAMPLE_SIZE - 1; i++) {
 		if (s->data[i] > s->data[i + 1])
@@ -148,167 +173,41 @@ bool sample_is_sorted(SAMPLES * s) {
 	return true;
 }
 
-void sample_show(SAMPLES * s, int u, int v, int t){
-	int i, j, c;
-	char temp[1024], buffer[128], sep[BOARD_WIDTH+1];
-	static char screen[16384];  /* Large buffer for entire screen */
-	static int last_u = -1, last_v = -1;  /* Track last swap for highlighting */
-	char stats_lines[10][64];  /* Statistics lines to display on right */
-	int stats_count = 0;
-	
-	/* skip visualization if disabled */
-	if (!ENABLE_VISUALIZATION) return;
-	
-	/* Clear screen buffer */
-	screen[0] = 0;
-	
-	/* setup horizontal line */
-	for (i = 0; i < BOARD_WIDTH; i++) 
-		sep[i] = VBAR;
-	sep[BOARD_WIDTH] = 0;
-
-	/* Prepare statistics for right side display */
-	if (SHOW_STATISTICS) {
-		sprintf(stats_lines[stats_count++], "%s+-----+", VT_COLOR(8));
-		sprintf(stats_lines[stats_count++], "%s|%sSTATS%s|", VT_COLOR(8), VT_COLOR(220), VT_COLOR(8));
-		sprintf(stats_lines[stats_count++], "%s+-----+", VT_COLOR(8));
-		sprintf(stats_lines[stats_count++], "%sCMP:%s%ld", VT_COLOR(244), VT_COLOR(39), s->comparisons);
-		sprintf(stats_lines[stats_count++], "%sSWP:%s%ld", VT_COLOR(244), VT_COLOR(196), s->swaps);
-	}
-
-	/* Add sort algorithm title to buffer */
-	strcat(screen, sortTitle);
-	strcat(screen, "\n");
-	
-	/* Add top horz. line to buffer */
-	sprintf(temp, "%s%s", VT_COLOR(8), sep);
-	if (SHOW_STATISTICS && stats_count > 0) {
-		strcat(temp, " ");
-		strcat(temp, stats_lines[0]);
-	}
-	strcat(temp, "\n");
-	strcat(screen, temp);
-
-	/* Add sort samples to buffer with stats on right */
-	for (j = 0; j < s->max; j++) {
-		temp[0] = 0;
-		for (i = 0; i < SAMPLE_SIZE; i++) {
-			c = (j < sample_height(s, i)) ? VSHADE : VBLOCK;
-			sprintf(buffer, " %s%lc%lc ", colors[s->data[i]-1], (wint_t) c, (wint_t) c);
-			strcat(temp, buffer);
-		}
-		
-		/* Add stats on the right side for appropriate rows */
-		if (SHOW_STATISTICS && j + 1 < stats_count) {
-			strcat(temp, " ");
-			strcat(temp, stats_lines[j + 1]);
-		}
-		
-		strcat(temp, "\n");
-		strcat(screen, temp);
-	}
-	
-	/* Add bottom horz. line to buffer */
-	sprintf(temp, "%s%s", VT_COLOR(8), sep);
-	if (SHOW_STATISTICS && s->max + 1 < stats_count) {
-		strcat(temp, " ");
-		strcat(temp, stats_lines[s->max + 1]);
-	}
-	strcat(temp, "\n");
-	strcat(screen, temp);
-	
-	/* Add sort values to buffer with enhanced highlighting */
-	temp[0] = 0;
-	for (i = 0; i < SAMPLE_SIZE; i++) {
-		if (i == u || i == v) {
-			/* Current comparison - bright yellow */
-			sprintf(buffer, "%s%s%3d%s ", VT_ATTR(1), VT_COLOR(226), s->data[i], VT_DEFAULTATTR);
-		} else if (SHOW_SORTED_REGION && s->sorted_until >= 0 && i <= s->sorted_until) {
-			/* Sorted region - green */
-			sprintf(buffer, "%s%3d%s ", VT_COLOR(46), s->data[i], VT_DEFAULTATTR);
-		} else if (HIGHLIGHT_SWAPS && (i == last_u || i == last_v)) {
-			/* Just swapped - cyan */
-			sprintf(buffer, "%s%3d%s ", VT_COLOR(51), s->data[i], VT_DEFAULTATTR);
-		} else {
-			/* Normal - gray */
-			sprintf(buffer, "%s%3d ", VT_COLOR(244), s->data[i]);
-		}
-		strcat(temp, buffer);
-	}
-	if (SHOW_STATISTICS && s->max + 2 < stats_count) {
-		strcat(temp, " ");
-		strcat(temp, stats_lines[s->max + 2]);
-	}
-	strcat(temp, "\n");
-	strcat(screen, temp);
-	
-	/* Update last swap positions */
-	if (u != last_u || v != last_v) {
-		last_u = u;
-		last_v = v;
-	}
-
-	/* Add current indices to buffer */
-	strcpy(temp, VT_COLOR(231));
-	for (i = 0; i < SAMPLE_SIZE; i++) {
-		if (i == u) c = VCURRENT; else 
-		if (i == v) c = VRUNNING; else 
-		if (i == t) c = VEXTRA; else 
-		c = 32;
-		sprintf(buffer, " %lc%lc ", (wint_t)c, (wint_t)c);
-		strcat(temp, buffer);
-	}
-	if (SHOW_STATISTICS && s->max + 3 < stats_count) {
-		strcat(temp, " ");
-		strcat(temp, stats_lines[s->max + 3]);
-	}
-	strcat(temp, "\n");
-	strcat(screen, temp);
-	
-	/* Write entire screen at once (atomic operation) */
-	fputs(screen, stdout);
-	fflush(stdout);
-	
-	reset_colors();
-}
 /*---- INTERCHANGE SORT --------------------*/
 void sample_sort_interchange(SAMPLES * s) {
 	int i, j;
     title("INTERCHANGE SORT");
 	for (i = 0; i < SAMPLE_SIZE-1; i++) {
-		s->sorted_until = i - 1;  /* Track sorted region */
+		sample_sorted(s, i - 1);  /* Track sorted region */
 		for (j = i + 1; j < SAMPLE_SIZE; j++) {
-			s->comparisons++;
+			sample_compared(s, i, j);
 			if (s->data[i] > s->data[j]) {
 				if (SMOOTH_TRANSITIONS) {
 					sample_swap_animated(s, i, j, i, j, -1);
 				} else {
 					sample_swap(s, i, j);
-					sample_show(s, i, j, -1);
-					mssleep(SAMPLE_SPEED);
+					sample_step(s, i, j, -1);
 				}
 			} else {
-				sample_show(s, i, j, -1);
-				mssleep(SAMPLE_SPEED);
+				sample_step(s, i, j, -1);
 			}
 		}
 	}
-	s->sorted_until = SAMPLE_SIZE - 1;
-	sample_show(s, -1, -1, -1);
+	sample_sorted(s, SAMPLE_SIZE - 1);
+	sample_frame(s, -1, -1, -1);
 }
 /*---- SELECTION SORT ----------------------*/
 void sample_sort_selection(SAMPLES * s) {
 	int i, j, minidx;
     title("SELECTION SORT");
 	for (i = 0; i < SAMPLE_SIZE-1; i++) {
-		s->sorted_until = i - 1;  /* Elements before i are sorted */
+		sample_sorted(s, i - 1);  /* Elements before i are sorted */
 		minidx = i;
 		for (j = i + 1; j < SAMPLE_SIZE; j++) {
-			s->comparisons++;
+			sample_compared(s, j, minidx);
 			if (s->data[j] < s->data[minidx])
 				minidx = j;
-			sample_show(s, i, j, minidx);
-			mssleep(SAMPLE_SPEED);
+			sample_step(s, i, j, minidx);
 		}
 		if (minidx != i) {
 			if (SMOOTH_TRANSITIONS) {
@@ -317,10 +216,10 @@ void sample_sort_selection(SAMPLES * s) {
 				sample_swap(s, i, minidx);
 			}
 		}
-		sample_show(s, i, j, minidx);
+		sample_frame(s, i, j, minidx);
 	}
-	s->sorted_until = SAMPLE_SIZE - 1;
-	sample_show(s, -1, -1, -1);
+	sample_sorted(s, SAMPLE_SIZE - 1);
+	sample_frame(s, -1, -1, -1);
 }
 /*---- BUBBLE SORT -------------------------*/
 void sample_sort_bubble(SAMPLES * s) {
@@ -329,51 +228,46 @@ void sample_sort_bubble(SAMPLES * s) {
     title("BUBBLE SORT");
 	for (i = 0; i < SAMPLE_SIZE-1; i++) {
 		swapped = false;
-		s->sorted_until = SAMPLE_SIZE - i - 1;  /* Elements after this are sorted */
+		sample_sorted(s, SAMPLE_SIZE - i - 1);  /* Elements after this are sorted */
 		for (j = 0; j < SAMPLE_SIZE-i-1; j++) {
-			s->comparisons++;
+			sample_compared(s, j, j+1);
 			if (s->data[j] > s->data[j+1]) {
 				if (SMOOTH_TRANSITIONS) {
 					sample_swap_animated(s, j, j+1, j, j+1, -1);
 				} else {
 					sample_swap(s, j, j+1);
-					sample_show(s, j, j+1, -1);
-					mssleep(SAMPLE_SPEED);
+					sample_step(s, j, j+1, -1);
 				}
 				swapped = true;
 			} else {
-				sample_show(s, j, j+1, -1);
-				mssleep(SAMPLE_SPEED);
+				sample_step(s, j, j+1, -1);
 			}
 		}
 		if (!swapped) break;
 	}
-	s->sorted_until = SAMPLE_SIZE - 1;
-	sample_show(s, -1, -1, -1);
+	sample_sorted(s, SAMPLE_SIZE - 1);
+	sample_frame(s, -1, -1, -1);
 }
 /*---- INSERTION SORT ----------------------*/
 void sample_sort_insertion(SAMPLES * s) {
 	int i, j, key;
     title("INSERTION SORT");
 	for (i = 1; i < SAMPLE_SIZE; i++) {
-		s->sorted_until = i - 1;  /* Elements 0 to i-1 are sorted */
+		sample_sorted(s, i - 1);  /* Elements 0 to i-1 are sorted */
 		key = s->data[i];
 		j = i-1;
 		while (j >= 0 && s->data[j] > key) {
-			s->comparisons++;
-			s->swaps++;  /* Shifting is essentially a swap */
-			s->data[j+1] = s->data[j];
+			sample_compared(s, j, -1);
+			sample_write(s, j+1, s->data[j]);  /* Shifting is essentially a swap */
 			j--;
-			sample_show(s, j, j+1, -1);
-			mssleep(SAMPLE_SPEED);
+			sample_step(s, j, j+1, -1);
 		}
-		if (j >= 0) s->comparisons++;  /* Count final comparison */
-		s->data[j+1] = key;
-		sample_show(s, i, j+1, -1);
-		mssleep(SAMPLE_SPEED);
+		if (j >= 0) sample_compared(s, j, -1);  /* Count final comparison */
+		sample_place(s, j+1, key);
+		sample_step(s, i, j+1, -1);
 	}
-	s->sorted_until = SAMPLE_SIZE - 1;
-	sample_show(s, -1, -1, -1);
+	sample_sorted(s, SAMPLE_SIZE - 1);
+	sample_frame(s, -1, -1, -1);
 }
 /*---- SHELL SORT --------------------------*/
 void sample_sort_shell(SAMPLES * s) {
@@ -385,19 +279,16 @@ void sample_sort_shell(SAMPLES * s) {
             temp = s->data[i];
             int j;
             for (j = i; j >= gap && s->data[j - gap] > temp; j -= gap) {
-                s->comparisons++;
-                s->swaps++;
-                s->data[j] = s->data[j - gap];
-				sample_show(s, j, j-gap, -1);
-				mssleep(SAMPLE_SPEED);
+                sample_compared(s, j - gap, -1);
+                sample_write(s, j, s->data[j - gap]);
+				sample_step(s, j, j-gap, -1);
 			}
-            if (j >= gap) s->comparisons++;  /* Count final comparison */
-            s->data[j] = temp;
-			sample_show(s, i, j, -1);
-			mssleep(SAMPLE_SPEED);
+            if (j >= gap) sample_compared(s, j - gap, -1);  /* Count final comparison */
+            sample_place(s, j, temp);
+			sample_step(s, i, j, -1);
         }
     }
-	sample_show(s, -1, -1, -1);
+	sample_frame(s, -1, -1, -1);
 }
 /*---- HEAP SORT ---------------------------*/
 void heapify(SAMPLES * s, int n, int i) {
@@ -406,18 +297,17 @@ void heapify(SAMPLES * s, int n, int i) {
     int right = 2 * i + 2;
 
     if (left < n) {
-        s->comparisons++;
+        sample_compared(s, left, largest);
         if (s->data[left] > s->data[largest]) largest = left;
     }
     if (right < n) {
-        s->comparisons++;
+        sample_compared(s, right, largest);
         if (s->data[right] > s->data[largest]) largest = right;
     }
 
     if (largest != i) {
         sample_swap(s, i, largest);
-		sample_show(s, i, n, largest);
-		mssleep(SAMPLE_SPEED);
+		sample_step(s, i, n, largest);
         heapify(s, n, largest);
     }
 }
@@ -429,107 +319,378 @@ void sample_sort_heap(SAMPLES * s) {
 		heapify(s, SAMPLE_SIZE, i);
     for (i = SAMPLE_SIZE - 1; i >= 0; i--) {
         sample_swap(s, 0, i);
-        sample_show(s, 0, i, -1);
-        mssleep(SAMPLE_SPEED);
+        sample_step(s, 0, i, -1);
         heapify(s, i, 0);
     }
-    sample_show(s, -1, -1, -1);
+    sample_frame(s, -1, -1, -1);
 } 
+/*---- NETWORK BASE CASE -------------------*/
+/* Quick and merge sort finish ranges of up to NET_BLOCK_MAX samples with a
+   sorting network kernel, but only when nobody records the sort: the
+   animation keeps showing every step of the original algorithm. */
+void sample_network_block(SAMPLES * s, int lo, int n) {
+	/* comparators count as comparisons, every slot that changed as a swap */
+	int before[NET_BLOCK_MAX], * a = s->data + lo;
+	memcpy(before, a, (size_t) n * sizeof(int));
+	s->comparisons += net_sort_small(a, n);
+	for (int i = 0; i < n; i++)
+		s->swaps += a[i] != before[i];
+}
+
+bool sample_network_base(SAMPLES * s, int lo, int hi) {
+	if (!NET_BASE || sample_events || hi - lo + 1 > NET_BLOCK_MAX) return false;
+	sample_network_block(s, lo, hi - lo + 1);
+	return true;
+}
+
 /*---- QUICK SORT --------------------------*/
-int partition(SAMPLES * s, int low, int high)
-{
-    int i = low, j = high, pivot = s->data[low];
-    while (i < j) {
-        while (i < high && pivot >= s->data[i]) {
-            s->comparisons++;
-            i++;
-        }
-        while (j > low && pivot < s->data[j]) {
-            s->comparisons++;
-            j--;
-        }
-        if (i < j) {
-			sample_swap(s, i, j);
-    	}
-        sample_show(s, i, j, pivot);
-   	    mssleep(SAMPLE_SPEED);
-    }
-    sample_swap(s, low, j);
-    sample_show(s, low, j, pivot);
-   	mssleep(SAMPLE_SPEED);
-    return j;
-}
-  
-void sample_sort_quick_recursive(SAMPLES * s, int low, int high) {
-    if (low < high) {
-        int pivot = partition(s, low, high);
-        sample_sort_quick_recursive(s, low, pivot - 1);
-        sample_sort_quick_recursive(s, pivot + 1, high);
-	    sample_show(s, low, high, pivot);
-    }
+/* Pattern-defeating quicksort. Pivots are the median of three, or of three
+   medians above QUICK_NINTHER; small ranges are left to insertion sort and
+   only the smaller side is recursed into. Every unbalanced partition spends
+   one of log n chances and shuffles a few elements to break the pattern,
+   after the last one the range is heap sorted, so no input goes quadratic.
+   A partition that moved nothing hints at sorted input, which a bounded
+   insertion sort then tries to finish. Block Quick Sort is the same loop
+   with the branchless block partition below. */
+#define	QUICK_NINTHER		128		/* ranges above this take a ninther pivot */
+#define	QUICK_PARTIAL		8		/* moves a partial insertion sort may make */
+#define	QUICK_BLOCK			64		/* samples classified per block, offsets fit a byte */
+int QUICK_INSERTION = 12;			/* ranges up to this are insertion sorted, low enough
+									   that the default 18 samples still partition */
+
+static bool quick_less(SAMPLES * s, int a, int b) {
+	sample_compared(s, a, b);
+	return s->data[a] < s->data[b];
+}
+
+static void quick_sort3(SAMPLES * s, int a, int b, int c) {
+	/* orders the values at a, b and c */
+	if (quick_less(s, b, a)) sample_swap(s, a, b);
+	if (quick_less(s, c, b)) {
+		sample_swap(s, b, c);
+		if (quick_less(s, b, a)) sample_swap(s, a, b);
+	}
+}
+
+/* Insertion sort of low..high. With limit > 0 it gives up once that many
+   elements were moved and returns false. */
+static bool quick_insertion(SAMPLES * s, int low, int high, int limit) {
+	int moved = 0;
+	for (int i = low + 1; i <= high; i++) {
+		int key = s->data[i], j = i - 1;
+		while (j >= low) {
+			sample_compared(s, j, -1);
+			if (s->data[j] <= key) break;
+			sample_write(s, j + 1, s->data[j]);
+			sample_step(s, j, j + 1, -1);
+			j--;
+		}
+		if (j == i - 1) continue;
+		sample_place(s, j + 1, key);
+		moved += i - 1 - j;
+		if (limit > 0 && moved > limit) return false;
+	}
+	return true;
+}
+
+static void quick_sift(SAMPLES * s, int base, int n, int i) {
+	/* sift down in the heap base..base+n-1 */
+	for (int child; (child = 2 * i + 1) < n; i = child) {
+		if (child + 1 < n && quick_less(s, base + child, base + child + 1)) child++;
+		if (!quick_less(s, base + i, base + child)) return;
+		sample_swap(s, base + i, base + child);
+		sample_step(s, base + i, base + child, -1);
+	}
+}
+
+static void quick_heap(SAMPLES * s, int low, int high) {
+	int n = high - low + 1;
+	sample_bounds(s, low, high);
+	for (int i = n / 2 - 1; i >= 0; i--)
+		quick_sift(s, low, n, i);
+	for (int i = n - 1; i > 0; i--) {
+		sample_swap(s, low, low + i);
+		quick_sift(s, low, i, 0);
+	}
+}
+
+/* Partitions low..high around the pivot at low: smaller values end up on
+   its left, the others on its right. Returns where the pivot landed and
+   tells whether the range was partitioned already. */
+static int quick_partition(SAMPLES * s, int low, int high, bool * already) {
+	int i = low + 1, j = high;
+	sample_bounds(s, low, high);
+	sample_pivot(s, low);
+	while (i <= high && quick_less(s, i, low)) i++;
+	while (j > low && !quick_less(s, j, low)) j--;
+	*already = i > j;
+	/* from here on the elements swapped stop both scans */
+	while (i < j) {
+		sample_swap(s, i, j);
+		sample_step(s, i, j, low);
+		while (quick_less(s, ++i, low)) ;
+		while (!quick_less(s, --j, low)) ;
+	}
+	if (j != low) sample_swap(s, low, j);
+	sample_pivot(s, j);
+	sample_step(s, low, j, j);
+	return j;
+}
+
+/* BlockQuicksort partition, same contract as quick_partition(). A block
+   of up to QUICK_BLOCK samples on each side is compared with the pivot,
+   storing the offset of every sample on the wrong side and adding the
+   outcome to the count instead of branching on it. Then as many pairs
+   as both blocks hold are swapped and an emptied block is refilled. Only
+   the loop bounds branch, so random input costs no mispredictions on
+   the comparisons. */
+static int quick_partition_block(SAMPLES * s, int low, int high, bool * already) {
+	unsigned char offl[QUICK_BLOCK], offr[QUICK_BLOCK];
+	const int * data = s->data;
+	int pivot = data[low], i = low + 1, j = high;
+	sample_bounds(s, low, high);
+	sample_pivot(s, low);
+	while (i <= high && quick_less(s, i, low)) i++;
+	while (j > low && !quick_less(s, j, low)) j--;
+	*already = i > j;
+
+	if (i < j) {
+		/* first and last bound the unclassified samples, basel and baser
+		   the blocks the offsets count from */
+		int first = i + 1, last = j, basel = first, baser = last;
+		int numl = 0, numr = 0, startl = 0, startr = 0;
+		sample_swap(s, i, j);
+		while (first < last) {
+			int unknown = last - first;
+			int splitl = numl ? 0 : numr ? unknown : unknown / 2;
+			int splitr = numr ? 0 : unknown - splitl;
+			if (splitl > QUICK_BLOCK) splitl = QUICK_BLOCK;
+			if (splitr > QUICK_BLOCK) splitr = QUICK_BLOCK;
+			for (int k = 0; k < splitl; k++) {
+				offl[numl] = (unsigned char) k;
+				numl += !(data[first + k] < pivot);
+			}
+			for (int k = 1; k <= splitr; k++) {
+				offr[numr] = (unsigned char) k;
+				numr += data[last - k] < pivot;
+			}
+			if (sample_events) {
+				for (int k = 0; k < splitl; k++) sample_compared(s, first + k, low);
+				for (int k = 1; k <= splitr; k++) sample_compared(s, last - k, low);
+			}
+			else s->comparisons += splitl + splitr;
+			first += splitl;
+			last -= splitr;
+
+			int num = numl < numr ? numl : numr;
+			for (int k = 0; k < num; k++) {
+				int a = basel + offl[startl + k], b = baser - offr[startr + k];
+				sample_swap(s, a, b);
+				sample_step(s, a, b, low);
+			}
+			numl -= num;
+			numr -= num;
+			startl += num;
+			startr += num;
+			if (!numl) { startl = 0; basel = first; }
+			if (!numr) { startr = 0; baser = last; }
+		}
+		/* the block left over swaps with the edge of the other side */
+		if (numl) {
+			while (numl--) sample_swap(s, basel + offl[startl + numl], --last);
+			first = last;
+		}
+		while (numr--) sample_swap(s, baser - offr[startr + numr], first++);
+		j = first - 1;
+	}
+	if (j != low) sample_swap(s, low, j);
+	sample_pivot(s, j);
+	sample_step(s, low, j, j);
+	return j;
+}
+
+/* Like quick_partition() but values equal to the pivot go left. Used when
+   the value before the range equals the pivot, so that whole left side is
+   equal and done. */
+static int quick_partition_left(SAMPLES * s, int low, int high) {
+	int i = low + 1, j = high;
+	sample_bounds(s, low, high);
+	sample_pivot(s, low);
+	while (j > low && quick_less(s, low, j)) j--;
+	while (i <= j && !quick_less(s, low, i)) i++;
+	while (i < j) {
+		sample_swap(s, i, j);
+		sample_step(s, i, j, low);
+		while (!quick_less(s, low, ++i)) ;
+		while (quick_less(s, low, --j)) ;
+	}
+	if (j != low) sample_swap(s, low, j);
+	sample_pivot(s, j);
+	return j;
+}
+
+static void quick_break(SAMPLES * s, int a, int b, int n) {
+	/* swaps a few elements of an unbalanced side to defeat its pattern */
+	int q = n / 4;
+	if (n < QUICK_INSERTION) return;
+	sample_swap(s, a, a + q);
+	sample_swap(s, b, b - q);
+	if (n > QUICK_NINTHER) {
+		sample_swap(s, a + 1, a + q + 1);
+		sample_swap(s, a + 2, a + q + 2);
+		sample_swap(s, b - 1, b - q - 1);
+		sample_swap(s, b - 2, b - q - 2);
+	}
+}
+
+static void quick_loop(SAMPLES * s, int low, int high, int bad, bool leftmost, int depth, bool block) {
+	bool already;
+	sample_depth(s, depth);
+	while (low < high) {
+		int n = high - low + 1, mid = low + n / 2;
+		if (sample_network_base(s, low, high)) return;
+		if (n <= QUICK_INSERTION) {
+			quick_insertion(s, low, high, 0);
+			return;
+		}
+
+		if (n > QUICK_NINTHER) {
+			quick_sort3(s, low, mid, high);
+			quick_sort3(s, low + 1, mid - 1, high - 1);
+			quick_sort3(s, low + 2, mid + 1, high - 2);
+			quick_sort3(s, mid - 1, mid, mid + 1);
+			sample_swap(s, low, mid);
+		}
+		else quick_sort3(s, mid, low, high);
+
+		/* a run of equal values: put them left of the pivot and skip them */
+		if (!leftmost && !quick_less(s, low - 1, low)) {
+			low = quick_partition_left(s, low, high) + 1;
+			continue;
+		}
+
+		int p = block ? quick_partition_block(s, low, high, &already) : quick_partition(s, low, high, &already);
+		int left = p - low, right = high - p;
+		sample_frame(s, low, high, p);
+		if (left < n / 8 || right < n / 8) {
+			if (--bad == 0) {
+				quick_heap(s, low, high);
+				return;
+			}
+			quick_break(s, low, p - 1, left);
+			quick_break(s, p + 1, high, right);
+		}
+		else if (already && quick_insertion(s, low, p - 1, QUICK_PARTIAL) &&
+				 quick_insertion(s, p + 1, high, QUICK_PARTIAL))
+			return;
+
+		/* recurse into the smaller side, loop on the larger one */
+		if (left < right) {
+			quick_loop(s, low, p - 1, bad, leftmost, depth + 1, block);
+			low = p + 1;
+			leftmost = false;
+		} else {
+			quick_loop(s, p + 1, high, bad, false, depth + 1, block);
+			high = p - 1;
+		}
+	}
+}
+
+static void quick_range(SAMPLES * s, int low, int high, bool block) {
+	int bad = 1;
+	for (int n = high - low + 1; n > 1; n >>= 1) bad++;
+	quick_loop(s, low, high, bad, true, 1, block);
+    sample_pivot(s, -1);
+    sample_bounds(s, -1, -1);
+    sample_frame(s, -1, -1, -1);
 }
 
 void sample_sort_quick(SAMPLES * s, int low, int high) {
 	title("QUICK SORT");
-	sample_sort_quick_recursive(s, low, high);
-    sample_show(s, -1, -1, -1);
-} 
+	quick_range(s, low, high, false);
+}
+
+void sample_sort_quick_block(SAMPLES * s) {
+	title("BLOCK QUICK SORT");
+	quick_range(s, 0, SAMPLE_SIZE - 1, true);
+}
+
 /*---- MERGE SORT --------------------------*/
-void merge(SAMPLES * s, int l, int m, int r) {
-    int i, j, k;
-    int n1 = m - l + 1, n2 = r - m;
-    int L[n1], R[n2]; 
-  
-    for (i = 0; i < n1; i++) L[i] = s->data[l + i];
-    for (j = 0; j < n2; j++) R[j] = s->data[m + 1 + j];
-
-    i = 0; j = 0; k = l;
-    while (i < n1 && j < n2) {
-        s->comparisons++;
-        if (L[i] <= R[j]) {
-            s->data[k] = L[i];
-            i++;
-        }
-        else {
-            s->data[k] = R[j];
-            j++;
-        }
-        s->swaps++;
-        k++;
-	    sample_show(s, l, r, m);
-        mssleep(SAMPLE_SPEED);
-    }
-    while (i < n1) {  
-        s->data[k] = L[i];
-        s->swaps++;
-        i++;
-        k++;
-	    sample_show(s, l, r, m);
-        mssleep(SAMPLE_SPEED);
-    }
-    while (j < n2) {  
-        s->data[k] = R[j];
-        s->swaps++;
-        j++;
-        k++;
-	    sample_show(s, l, r, m);
-        mssleep(SAMPLE_SPEED);
-    }
+/* Bottom-up: runs of width w are merged pairwise into the other buffer and
+   the buffers swap roles, so nothing is copied back between passes. Pairs
+   already in order are copied without merging. The scratch buffer comes
+   from the arena and stays there for the next run. Compares and writes
+   are reported with their logical index, so replayed and live animations
+   show every pass in place (see live_flush()), and flagged when they go
+   to scratch. */
+static int merge_flags(SAMPLES * s, const int * buf) {
+	/* where an access to buf goes, for the events */
+	return buf == s->data ? 0 : EV_IN_SCRATCH;
 }
 
-void sample_sort_merge_recursive(SAMPLES * s, int l, int r) {
-    if (l < r) {
-        int m = (l + r) >> 1; 
-        sample_sort_merge_recursive(s, l, m);
-        sample_sort_merge_recursive(s, m + 1, r);
-        merge(s, l, m, r);
-    }
+static void merge_put(SAMPLES * s, int * dst, int k, int v) {
+	dst[k] = v;
+	s->swaps++;
+	event_emit(EV_WRITE, k, v, EV_COUNTED | merge_flags(s, dst));
+}
+
+static void merge_compared(SAMPLES * s, const int * src, int i, int j) {
+	s->comparisons++;
+	event_emit(EV_COMPARE, i, j, merge_flags(s, src));
+}
+
+static void merge_pass(SAMPLES * s, const int * src, int * dst, int lo, int mid, int hi) {
+	/* src lo..mid-1 and mid..hi-1 into dst lo..hi-1 */
+	int i = lo, j = mid, k = lo;
+	if (mid < hi) merge_compared(s, src, mid - 1, mid);
+	if (mid >= hi || src[mid - 1] <= src[mid]) {
+		memcpy(dst + lo, src + lo, (size_t)(hi - lo) * sizeof(int));
+		sample_copied(s, hi - lo);
+		return;
+	}
+	sample_bounds(s, lo, hi - 1);
+	while (i < mid && j < hi) {
+		merge_compared(s, src, i, j);
+		merge_put(s, dst, k++, (src[i] <= src[j]) ? src[i++] : src[j++]);
+		sample_step(s, lo, hi - 1, mid);
+	}
+	while (i < mid) {
+		merge_put(s, dst, k++, src[i++]);
+		sample_step(s, lo, hi - 1, mid);
+	}
+	/* the rest of the right run is where it was */
+	memcpy(dst + j, src + j, (size_t)(hi - j) * sizeof(int));
+	sample_copied(s, hi - lo);
 }
 
 void sample_sort_merge(SAMPLES * s, int l, int r) {
+	int n = r - l + 1, w = 1, lo;
+	int * src = s->data, * dst = (int *) scratch_get((size_t) SAMPLE_SIZE * sizeof(int), USE_HUGE_PAGES);
+
     title("MERGE SORT");
-    sample_sort_merge_recursive(s, l, r);
-    sample_show(s, -1, -1, -1);
+	if (!dst) die(1, "Error: Out of memory for merge sort\n");
+	sample_aux(s, n);
+
+	/* unrecorded runs start from blocks sorted by the network base case */
+	for (lo = l; lo <= r; lo += NET_BLOCK_MAX) {
+		int hi = (lo + NET_BLOCK_MAX - 1 < r) ? lo + NET_BLOCK_MAX - 1 : r;
+		if (!sample_network_base(s, lo, hi)) break;
+		w = NET_BLOCK_MAX;
+	}
+	for (; w < n; w <<= 1) {
+		for (lo = l; lo <= r; lo += 2 * w) {
+			int mid = (lo + w <= r) ? lo + w : r + 1;
+			int hi = (mid + w <= r) ? mid + w : r + 1;
+			merge_pass(s, src, dst, lo, mid, hi);
+		}
+		int * t = src; src = dst; dst = t;
+	}
+	if (src != s->data) {
+		memcpy(s->data + l, src + l, (size_t) n * sizeof(int));
+		sample_copied(s, n);
+	}
+    sample_bounds(s, -1, -1);
+    sample_frame(s, -1, -1, -1);
 } 
 /*---- COMB SORT ----------------------------*/
 void sample_sort_comb(SAMPLES * s)  { 
@@ -537,52 +698,20 @@ void sample_sort_comb(SAMPLES * s)  {
 	bool swapped = true; 
     title("COMB SORT");
     while (gap != 1 || swapped)  { 
-	    gap = (gap*10)/13; 
+	    gap = (int)((long long) gap*10/13);	/* gap*10 passes int past 2^28 */
     	if (gap < 1) gap = 1; 
         swapped = false; 
         for (i = 0; i < SAMPLE_SIZE - gap; i++)  { 
-            s->comparisons++;
+            sample_compared(s, i, i+gap);
             if (s->data[i] > s->data[i+gap]) { 
                 sample_swap(s, i, i+gap); 
                 swapped = true;
             } 
-	        sample_show(s, i, i+gap, -1);
-    	    mssleep(SAMPLE_SPEED);
+	        sample_step(s, i, i+gap, -1);
         } 
     } 
-	sample_show(s, -1, -1, -1);
+	sample_frame(s, -1, -1, -1);
 } 
-/*---- COUNTING SORT -----------------------*/
-void sample_sort_count(SAMPLES * s) {
-	int output[SAMPLE_SIZE]; 
-    int count[SAMPLE_SIZE + 1], i;
-    title("COUNTING SORT");
-	
-	for (i = 0; i <= SAMPLE_SIZE; i++) count[i] = 0;
-    for (i = 0; i < SAMPLE_SIZE; ++i) {
-		++count[s->data[i]];
-		s->comparisons++;  /* Counting operation */
-		sample_show(s, i, -1, -1);
-    	mssleep(SAMPLE_SPEED);
-	}
-    for (i = 1; i <= SAMPLE_SIZE; ++i)
-        count[i] += count[i - 1];
-    for (i = 0; i < SAMPLE_SIZE; ++i) {
-        output[count[s->data[i]] - 1] = s->data[i];
-        --count[s->data[i]];
-        s->swaps++;  /* Placement operation */
-		sample_show(s, -1, i, -1);
-    	mssleep(SAMPLE_SPEED);
-
-    }
-    for (i = 0; i < SAMPLE_SIZE; ++i) {    	
-		s->data[i] = output[i];
-		s->swaps++;
-		sample_show(s, i, -1, -1);
-    	mssleep(SAMPLE_SPEED);
-	}
-    sample_show(s, -1, -1, -1);
-}
 /*---- COCKTAIL SORT -----------------------*/
 void sample_sort_cocktail(SAMPLES * s) {	
     int swapped = 1, start = 0, end = SAMPLE_SIZE - 1, i;
@@ -590,13 +719,12 @@ void sample_sort_cocktail(SAMPLES * s) {
     while (swapped) {
         swapped = 0;
         for (i = start; i < end; i++) {
-            s->comparisons++;
+            sample_compared(s, i, i + 1);
             if (s->data[i] > s->data[i + 1]) {
                 sample_swap(s, i, i + 1);
                 swapped = 1;
             }
-			sample_show(s, i, i+1, -1);
-    		mssleep(SAMPLE_SPEED);
+			sample_step(s, i, i+1, -1);
         }
  
         if (!swapped) break;
@@ -604,56 +732,157 @@ void sample_sort_cocktail(SAMPLES * s) {
         --end;
  
         for (i = end - 1; i >= start; i--) {
-            s->comparisons++;
+            sample_compared(s, i, i + 1);
             if (s->data[i] > s->data[i + 1]) {
                 sample_swap(s, i, i + 1);
                 swapped = 1;
             }
-			sample_show(s, i, i+1, -1);
-    		mssleep(SAMPLE_SPEED);
+			sample_step(s, i, i+1, -1);
         }
         ++start;
     }
-    sample_show(s, -1, -1, -1);
+    sample_frame(s, -1, -1, -1);
 }
 /*---- RADIX SORT -----------------------*/
-void count_sort_radix(SAMPLES * s, int exp) {
-	SAMPLES output;
-	int count[10] = { 0 };
+/* Least significant digit first on 8-bit digits. One read pass builds the
+   histograms of every digit, passes whose digit is the same for all keys
+   are skipped, and the others scatter back and forth between the keys and
+   one scratch buffer. Signed and floating point keys are mapped to
+   unsigned ones by order preserving bit flips, and back on the last copy. */
+#define	RADIX_UNSIGNED		0
+#define	RADIX_SIGNED		1
+#define	RADIX_FLOAT			2		/* IEEE 754, negative zero sorts before zero, NaNs go
+										   to the end of their sign: -NaN first, NaN last */
 
-	output.max = s->max;
-	for (int i = 0; i < SAMPLE_SIZE; i++) {
-		output.data[i] = 1;
-		count[(s->data[i] / exp) % 10]++;
-		s->comparisons++;  /* Classification operation */
+static unsigned radix_in32(unsigned x, int kind) {
+	if (kind == RADIX_SIGNED) return x ^ 0x80000000u;
+	if (kind == RADIX_FLOAT)  return x ^ (-(x >> 31) | 0x80000000u);	/* negatives flip all */
+	return x;
+}
+
+static unsigned radix_out32(unsigned x, int kind) {
+	if (kind == RADIX_SIGNED) return x ^ 0x80000000u;
+	if (kind == RADIX_FLOAT)  return x ^ (((x >> 31) - 1) | 0x80000000u);
+	return x;
+}
+
+static unsigned long long radix_in64(unsigned long long x, int kind) {
+	const unsigned long long sign = 1ULL << 63;
+	if (kind == RADIX_SIGNED) return x ^ sign;
+	if (kind == RADIX_FLOAT)  return x ^ (-(x >> 63) | sign);
+	return x;
+}
+
+static unsigned long long radix_out64(unsigned long long x, int kind) {
+	const unsigned long long sign = 1ULL << 63;
+	if (kind == RADIX_SIGNED) return x ^ sign;
+	if (kind == RADIX_FLOAT)  return x ^ (((x >> 63) - 1) | sign);
+	return x;
+}
+
+static bool radix_offsets(size_t * count, size_t n) {
+	/* turns a digit histogram into bucket starts, false when one bucket holds all */
+	size_t sum = 0;
+	for (int b = 0; b < 256; b++) {
+		if (count[b] == n) return false;
+		size_t c = count[b];
+		count[b] = sum;
+		sum += c;
 	}
+	return true;
+}
 
-	for (int i = 1; i < 10; i++)
-		count[i] += count[i - 1];
+/* Sorts n 32-bit keys of the given RADIX_* kind, tmp holds n more.
+   Returns the scatter passes run. */
+int radix_sort32(unsigned * a, unsigned * tmp, size_t n, int kind) {
+	size_t count[4][256] = { { 0 } }, i;
+	unsigned * src = a, * dst = tmp, * t;
+	int passes = 0;
 
-	for (int i = SAMPLE_SIZE - 1; i >= 0; i--) {
-		output.data[count[(s->data[i] / exp) % 10] - 1] = s->data[i];
-		count[(s->data[i] / exp) % 10]--;
-		s->swaps++;  /* Placement operation */
-		sample_show(s, i, -1, -1);
-    	mssleep(SAMPLE_SPEED);
+	for (i = 0; i < n; i++) {
+		unsigned k = a[i] = radix_in32(a[i], kind);
+		count[0][k & 0xFF]++;
+		count[1][(k >> 8) & 0xFF]++;
+		count[2][(k >> 16) & 0xFF]++;
+		count[3][k >> 24]++;
+	}
+	for (int d = 0; d < 4; d++) {
+		if (!radix_offsets(count[d], n)) continue;
+		for (i = 0; i < n; i++)
+			dst[count[d][(src[i] >> (8 * d)) & 0xFF]++] = src[i];
+		t = src; src = dst; dst = t;
+		passes++;
 	}
+	for (i = 0; i < n; i++) a[i] = radix_out32(src[i], kind);
+	return passes;
+}
 
-	for (int i = 0; i < SAMPLE_SIZE; i++) {
-		s->data[i] = output.data[i];
-		s->swaps++;
-		sample_show(s, i, -1, -1);
-    	mssleep(SAMPLE_SPEED);
+/* Same for 64-bit keys */
+int radix_sort64(unsigned long long * a, unsigned long long * tmp, size_t n, int kind) {
+	size_t count[8][256] = { { 0 } }, i;
+	unsigned long long * src = a, * dst = tmp, * t;
+	int passes = 0;
+
+	for (i = 0; i < n; i++) {
+		unsigned long long k = a[i] = radix_in64(a[i], kind);
+		for (int d = 0; d < 8; d++)
+			count[d][(k >> (8 * d)) & 0xFF]++;
+	}
+	for (int d = 0; d < 8; d++) {
+		if (!radix_offsets(count[d], n)) continue;
+		for (i = 0; i < n; i++)
+			dst[count[d][(src[i] >> (8 * d)) & 0xFF]++] = src[i];
+		t = src; src = dst; dst = t;
+		passes++;
 	}
+	for (i = 0; i < n; i++) a[i] = radix_out64(src[i], kind);
+	return passes;
 }
 
-void sample_sort_radix(SAMPLES * s) {	
+static void radix_show(SAMPLES * s, unsigned * tmp) {
+	/* the same passes, each scattering a copy back into the samples so the
+	   buckets can be seen filling, the current one marked by the bounds */
+	size_t count[4][256] = { { 0 } }, start[256];
+	int i;
+
+	for (i = 0; i < SAMPLE_SIZE; i++) {
+		unsigned k = radix_in32((unsigned) s->data[i], RADIX_SIGNED);
+		for (int d = 0; d < 4; d++)
+			count[d][(k >> (8 * d)) & 0xFF]++;
+		sample_compared(s, i, -1);		/* classification */
+		sample_step(s, i, -1, -1);
+	}
+	for (int d = 0; d < 4; d++) {
+		if (!radix_offsets(count[d], SAMPLE_SIZE)) continue;
+		memcpy(start, count[d], sizeof(start));
+		memcpy(tmp, s->data, (size_t) SAMPLE_SIZE * sizeof(int));
+		for (i = 0; i < SAMPLE_SIZE; i++) {
+			int b = (radix_in32(tmp[i], RADIX_SIGNED) >> (8 * d)) & 0xFF;
+			int end = (b < 255) ? (int) start[b + 1] - 1 : SAMPLE_SIZE - 1;
+			int at = (int) count[d][b]++;
+			sample_bounds(s, (int) start[b], end);
+			sample_accessed(s, i, EV_IN_SCRATCH);
+			sample_write(s, at, (int) tmp[i]);
+			sample_step(s, at, -1, -1);
+		}
+	}
+	sample_bounds(s, -1, -1);
+}
+
+void sample_sort_radix(SAMPLES * s) {
+	unsigned * tmp = (unsigned *) mem_alloc((size_t) SAMPLE_SIZE * sizeof(int), USE_HUGE_PAGES);
+	if (!tmp) die(1, "Error: Out of memory for radix sort\n");
+	sample_aux(s, SAMPLE_SIZE);
     title("RADIX SORT");
-	int m = s->max;
-	for (int exp = 1; m / exp > 0; exp *= 10) {
-		count_sort_radix(s, exp);
+	if (sample_events) radix_show(s, tmp);
+	else {
+		/* one classification per sample, one write per sample and pass */
+		int passes = radix_sort32((unsigned *) s->data, tmp, SAMPLE_SIZE, RADIX_SIGNED);
+		s->comparisons += SAMPLE_SIZE;
+		s->swaps += (long) passes * SAMPLE_SIZE;
 	}
-    sample_show(s, -1, -1, -1);
+	mem_free(tmp);
+    sample_frame(s, -1, -1, -1);
 }
 
 bool circleSortRec(SAMPLES * s, int left, int right) {
@@ -670,15 +899,11 @@ bool circleSortRec(SAMPLES * s, int left, int right) {
     // Compare and swap elements from both ends toward the center
     while (l < r) {
         if (s->data[l] > s->data[r]) {
-			s->comparisons++;
-			s->swaps++;
-            int temp = s->data[l];
-            s->data[l] = s->data[r];
-            s->data[r] = temp;
+			sample_compared(s, l, r);
+			sample_swap(s, l, r);
             swapped = true;
 
-			sample_show(s, -1, l, r);
-    		mssleep(SAMPLE_SPEED);
+			sample_step(s, -1, l, r);
         }
         l++;
         r--;
@@ -686,14 +911,10 @@ bool circleSortRec(SAMPLES * s, int left, int right) {
 
     // If odd number of elements, check the middle element
     if (l == r && s->data[l] > s->data[r + 1]) {
-        int temp = s->data[l];
-        s->data[l] = s->data[r + 1];
-        s->data[r + 1] = temp;
+        sample_swap(s, l, r + 1);
         swapped = true;
-		s->comparisons++;
-		s->swaps++;
-		sample_show(s, -1, l, r + 1);
-    	mssleep(SAMPLE_SPEED);
+		sample_compared(s, l, r + 1);
+		sample_step(s, -1, l, r + 1);
     }
 
     // Recursively sort the left and right halves
@@ -708,6 +929,1044 @@ void sample_sort_circle(SAMPLES * s) {
 	title("CIRCLE SORT");
 	int n = s->max;
 	while (circleSortRec(s, 0, n - 1));
+	sample_frame(s, -1, -1, -1);
+}
+
+/*---- PARALLEL MERGE SORT -----------------*/
+/* Halves are forked onto the pool down to a grain, then large merges are
+   cut with merge path into pieces that write disjoint output ranges.
+   Counters are kept per task and added once at its end. */
+typedef struct counters {
+	long	comparisons;
+	long	swaps;
+} COUNTERS;
+
+void counters_add(SAMPLES * s, const COUNTERS * c) {
+	__atomic_fetch_add(&s->comparisons, c->comparisons, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&s->swaps, c->swaps, __ATOMIC_RELAXED);
+}
+
+void sample_region_at(SAMPLES * s, int slot, int lo, int hi) {
+	/* marks a range with the color of slot */
+	s->region[slot % REGION_COUNT].lo = lo;
+	s->region[slot % REGION_COUNT].hi = hi;
+	event_emit(EV_REGION, lo, hi, slot);
 }
 
-#endif
\ No newline at end of file
+void sample_region(SAMPLES * s, int lo, int hi) {
+	/* marks the range the calling thread works on */
+	sample_region_at(s, pool_self, lo, hi);
+}
+
+void sample_regions_clear(SAMPLES * s) {
+	for (int r = 0; r < REGION_COUNT; r++) {
+		s->region[r].lo = s->region[r].hi = -1;
+		event_emit(EV_REGION, -1, -1, r);
+	}
+}
+
+typedef struct pmerge_job {
+	SAMPLES *	s;
+	int *		out;				/* where the sorted or merged range lands */
+	int *		in;					/* the other buffer, holding the runs to merge */
+	int			lo, mid, hi;		/* sort lo..hi, or merge lo..mid with mid+1..hi */
+	int			d0, d1;				/* output range of a merge piece, from lo */
+	int			grain;				/* ranges up to this size are not split */
+} PMERGE_JOB;
+
+static int pmerge_corank(const int * a, int na, const int * b, int nb, int d, int base, int flags, COUNTERS * c) {
+	/* elements taken from a among the first d merged ones, ties go to a */
+	int lo = d > nb ? d - nb : 0, hi = d < na ? d : na;
+	while (lo < hi) {
+		int i = (lo + hi) >> 1;
+		c->comparisons++;
+		event_emit(EV_COMPARE, base + i, base + na + d - i - 1, flags);
+		if (a[i] <= b[d - i - 1]) lo = i + 1; else hi = i;
+	}
+	return lo;
+}
+
+static void pmerge_piece(void * arg) {
+	PMERGE_JOB * j = (PMERGE_JOB *) arg;
+	SAMPLES * s = j->s;
+	COUNTERS c = { 0, 0 };
+	const int * a = j->in + j->lo, * b = j->in + j->mid + 1;
+	int na = j->mid - j->lo + 1, nb = j->hi - j->mid;
+	int in = merge_flags(s, j->in), out = EV_COUNTED | merge_flags(s, j->out);
+	int i  = pmerge_corank(a, na, b, nb, j->d0, j->lo, in, &c), k;
+	int i1 = pmerge_corank(a, na, b, nb, j->d1, j->lo, in, &c);
+	int l = j->d0 - i, l1 = j->d1 - i1;
+
+	if (j->hi - j->lo + 1 > j->grain)
+		sample_region(s, j->lo + j->d0, j->lo + j->d1 - 1);
+	for (k = j->lo + j->d0; i < i1 || l < l1; k++) {
+		if (i < i1 && l < l1) {
+			c.comparisons++;
+			event_emit(EV_COMPARE, j->lo + i, j->mid + 1 + l, in);
+		}
+		if (l >= l1 || (i < i1 && a[i] <= b[l])) j->out[k] = a[i++];
+		else j->out[k] = b[l++];
+		if (sample_events) {
+			/* the logical index, wherever the pass writes to */
+			event_emit(EV_WRITE, k, j->out[k], out);
+			sample_step(s, j->lo, j->hi, j->mid);
+		}
+	}
+	c.swaps = j->d1 - j->d0;
+	counters_add(s, &c);
+}
+
+static void pmerge_merge(SAMPLES * s, int * out, int * in, int lo, int mid, int hi, int grain) {
+	PMERGE_JOB piece[POOL_MAX_THREADS];
+	TASK_GROUP g = { 0 };
+	int n = hi - lo + 1, p, pieces = n / grain;
+	if (pieces > pool_size()) pieces = pool_size();
+	if (pieces < 1) pieces = 1;
+
+	for (p = 0; p < pieces; p++) {
+		PMERGE_JOB j = { s, out, in, lo, mid, hi, (int)((long long) n * p / pieces),
+						 (int)((long long) n * (p + 1) / pieces), grain };
+		piece[p] = j;
+	}
+	for (p = 1; p < pieces; p++) pool_spawn(&g, pmerge_piece, &piece[p]);
+	pmerge_piece(&piece[0]);
+	pool_wait(&g);
+}
+
+static void pmerge_sort(void * arg) {
+	/* the halves are sorted into the other buffer and merged back into
+	   out, so the buffers swap roles on every level; a single sample is
+	   in both already */
+	PMERGE_JOB * j = (PMERGE_JOB *) arg;
+	if (j->lo >= j->hi) return;
+	int mid = (j->lo + j->hi) >> 1;
+	if (j->hi - j->lo + 1 > j->grain) {
+		TASK_GROUP g = { 0 };
+		PMERGE_JOB left  = { j->s, j->in, j->out, j->lo, 0, mid, 0, 0, j->grain };
+		PMERGE_JOB right = { j->s, j->in, j->out, mid + 1, 0, j->hi, 0, 0, j->grain };
+		pool_spawn(&g, pmerge_sort, &left);
+		pmerge_sort(&right);
+		pool_wait(&g);
+	}
+	else {
+		/* d0 tells the halves they are inside a range already marked */
+		PMERGE_JOB left  = { j->s, j->in, j->out, j->lo, 0, mid, 1, 0, j->grain };
+		PMERGE_JOB right = { j->s, j->in, j->out, mid + 1, 0, j->hi, 1, 0, j->grain };
+		if (!j->d0) sample_region(j->s, j->lo, j->hi);
+		pmerge_sort(&left);
+		pmerge_sort(&right);
+	}
+	pmerge_merge(j->s, j->out, j->in, j->lo, mid, j->hi, j->grain);
+}
+
+void sample_sort_merge_parallel(SAMPLES * s) {
+	int threads = pool_size();
+	int grain = SAMPLE_SIZE / (threads * 4);
+	int * tmp = (int *) mem_alloc((size_t) SAMPLE_SIZE * sizeof(int), USE_HUGE_PAGES);
+	if (!tmp) die(1, "Error: Out of memory for parallel merge sort\n");
+	sample_aux(s, SAMPLE_SIZE);
+	if (grain < 4) grain = 4;
+
+	title("PARALLEL MERGE");
+	/* the one copy of the run: single samples, the runs of the deepest
+	   merges, are then valid in either buffer */
+	memcpy(tmp, s->data, (size_t) SAMPLE_SIZE * sizeof(int));
+	sample_copied(s, SAMPLE_SIZE);
+	PMERGE_JOB all = { s, s->data, tmp, 0, 0, SAMPLE_SIZE - 1, 0, 0, grain };
+	pmerge_sort(&all);
+	mem_free(tmp);
+	sample_regions_clear(s);
+	sample_frame(s, -1, -1, -1);
+}
+
+/*---- PARALLEL QUICK SORT -----------------*/
+/* Partitions above a cutoff are spawned onto the work-stealing pool, the
+   larger side as a task while the spawner keeps going on the smaller one,
+   so each thread holds at most log n tasks. Below the cutoff a thread
+   finishes the range inline. Counters live in one cache line per thread
+   and are summed into the samples as tasks end. */
+typedef struct thread_counters {
+	long	comparisons;
+	long	swaps;
+	char	pad[CACHE_LINE - 2 * sizeof(long)];
+} THREAD_COUNTERS;
+
+static THREAD_COUNTERS	pquickCount[POOL_MAX_THREADS];
+
+typedef struct pquick_job {
+	SAMPLES *	s;
+	int			lo, hi;
+	int			owner;				/* thread that spawned the job */
+	int			cutoff;				/* ranges up to this size are not spawned */
+} PQUICK_JOB;
+
+static void pquick_flush(SAMPLES * s) {
+	THREAD_COUNTERS * c = &pquickCount[pool_self];
+	COUNTERS sum = { c->comparisons, c->swaps };
+	counters_add(s, &sum);
+	c->comparisons = c->swaps = 0;
+}
+
+static void pquick_swap(SAMPLES * s, THREAD_COUNTERS * c, int a, int b) {
+	int t = s->data[a];
+	s->data[a] = s->data[b];
+	s->data[b] = t;
+	c->swaps++;
+	event_emit(EV_SWAP, a, b, 0);
+}
+
+static bool pquick_less(SAMPLES * s, THREAD_COUNTERS * c, int a, int b) {
+	c->comparisons++;
+	event_emit(EV_COMPARE, a, b, 0);
+	return s->data[a] < s->data[b];
+}
+
+static int pquick_partition(SAMPLES * s, int low, int high) {
+	THREAD_COUNTERS * c = &pquickCount[pool_self];
+	int mid = low + ((high - low) >> 1), i = low, j = high + 1;
+
+	/* median of three ends up at low as the pivot */
+	if (pquick_less(s, c, mid, low)) pquick_swap(s, c, mid, low);
+	if (pquick_less(s, c, high, mid)) {
+		pquick_swap(s, c, high, mid);
+		if (pquick_less(s, c, mid, low)) pquick_swap(s, c, mid, low);
+	}
+	pquick_swap(s, c, low, mid);
+
+	/* both scans stop on keys equal to the pivot, so runs of duplicates
+	   are split in the middle instead of piling up on one side */
+	int pivot = s->data[low];
+	for (;;) {
+		do {
+			i++;
+			c->comparisons++;
+			event_emit(EV_COMPARE, low, i, 0);
+		} while (i < high && s->data[i] < pivot);
+		do {
+			j--;
+			c->comparisons++;
+			event_emit(EV_COMPARE, low, j, 0);
+		} while (s->data[j] > pivot);
+		if (i >= j) break;
+		pquick_swap(s, c, i, j);
+		sample_step(s, i, j, low);
+	}
+	pquick_swap(s, c, low, j);
+	sample_step(s, low, j, j);
+	return j;
+}
+
+static void pquick_serial(SAMPLES * s, int low, int high) {
+	while (low < high) {
+		int p = pquick_partition(s, low, high);
+		if (p - low < high - p) { pquick_serial(s, low, p - 1); low = p + 1; }
+		else { pquick_serial(s, p + 1, high); high = p - 1; }
+	}
+}
+
+void sample_stolen(SAMPLES * s) {
+	__atomic_fetch_add(&s->steals, 1, __ATOMIC_RELAXED);
+	event_emit(EV_STEAL, pool_self, 0, 0);
+}
+
+static void pquick_task(void * arg) {
+	PQUICK_JOB * j = (PQUICK_JOB *) arg;
+	PQUICK_JOB spawned[64];				/* larger sides, at most log n of them */
+	TASK_GROUP g = { 0 };
+	SAMPLES * s = j->s;
+	int lo = j->lo, hi = j->hi, n = 0;
+
+	if (j->owner != pool_self) sample_stolen(s);
+	sample_region(s, lo, hi);
+	while (hi - lo + 1 > j->cutoff && n < 64) {
+		int p = pquick_partition(s, lo, hi);
+		PQUICK_JOB big = { s, lo, hi, pool_self, j->cutoff };
+		if (p - lo < hi - p) { big.lo = p + 1; hi = p - 1; }
+		else { big.hi = p - 1; lo = p + 1; }
+		spawned[n] = big;
+		pool_spawn(&g, pquick_task, &spawned[n++]);
+		sample_region(s, lo, hi);
+	}
+	pquick_serial(s, lo, hi);
+	pquick_flush(s);
+	pool_wait(&g);
+}
+
+void sample_sort_quick_parallel(SAMPLES * s) {
+	int threads = pool_size();
+	int cutoff = SAMPLE_SIZE / (threads * 8);
+	if (cutoff < 4) cutoff = 4;
+
+	title("PARALLEL QUICK");
+	memset(pquickCount, 0, sizeof(pquickCount));
+	PQUICK_JOB all = { s, 0, SAMPLE_SIZE - 1, pool_self, cutoff };
+	pquick_task(&all);
+	sample_regions_clear(s);
+	sample_frame(s, -1, -1, -1);
+}
+
+/*---- COUNTING SORT -----------------------*/
+/* Takes any key range: a first pass finds min and max, then every thread
+   counts its slice of the samples into a private histogram, so counting
+   shares nothing. A prefix sum, split over blocks of keys, turns the
+   histograms into per-thread offsets and the threads scatter their slices
+   into scratch memory in parallel, stable, before it is copied back.
+   Ranges too wide for histograms of about the size of the samples go to
+   radix sort, whose memory does not depend on the keys. */
+#define	COUNT_SPREAD		2			/* histogram cells per sample allowed */
+#define	COUNT_RANGE_MIN		(1 << 16)	/* cells allowed whatever the size */
+#define	COUNT_GRAIN			(1 << 16)	/* fewest samples worth a thread */
+
+typedef struct count_job {
+	SAMPLES *	s;
+	int *		hist;				/* this slice's counters, then offsets */
+	int *		out;				/* scratch as large as the samples */
+	int			lo, hi;				/* slice of the samples, lo..hi-1 */
+	int			klo, khi;			/* block of keys for the prefix sum */
+	int			min, max;
+	int			range, slices;
+	long		base;				/* keys in the blocks before this one */
+	COUNTERS	c;
+} COUNT_JOB;
+
+static void count_fork(COUNT_JOB * jobs, int slices, void (*run)(void *)) {
+	TASK_GROUP g = { 0 };
+	for (int t = 1; t < slices; t++) pool_spawn(&g, run, &jobs[t]);
+	run(&jobs[0]);
+	pool_wait(&g);
+}
+
+static void count_bounds(void * arg) {
+	COUNT_JOB * j = (COUNT_JOB *) arg;
+	const int * a = j->s->data;
+	int min = a[j->lo], max = a[j->lo];
+	sample_region(j->s, j->lo, j->hi - 1);
+	for (int i = j->lo; i < j->hi; i++) {
+		j->c.comparisons++;
+		event_emit(EV_COMPARE, i, -1, 0);
+		if (a[i] < min) min = a[i];
+		else {
+			j->c.comparisons++;
+			event_emit(EV_COMPARE, i, -1, 0);
+			if (a[i] > max) max = a[i];
+		}
+		sample_step(j->s, i, -1, -1);
+	}
+	j->min = min;
+	j->max = max;
+}
+
+static void count_histogram(void * arg) {
+	COUNT_JOB * j = (COUNT_JOB *) arg;
+	const int * a = j->s->data;
+	int * hist = j->hist, min = j->min;
+	memset(hist, 0, (size_t) j->range * sizeof(int));
+	for (int i = j->lo; i < j->hi; i++) {
+		hist[a[i] - min]++;
+		sample_step(j->s, i, -1, -1);
+	}
+}
+
+static void count_total(void * arg) {
+	/* keys of the block counted by all slices, hist points at slice 0 */
+	COUNT_JOB * j = (COUNT_JOB *) arg;
+	long total = 0;
+	for (int t = 0; t < j->slices; t++) {
+		const int * h = j->hist + (size_t) t * j->range;
+		for (int k = j->klo; k < j->khi; k++) total += h[k];
+	}
+	j->base = total;
+}
+
+static void count_offsets(void * arg) {
+	/* counters become the first position of each key in each slice */
+	COUNT_JOB * j = (COUNT_JOB *) arg;
+	long next = j->base;
+	for (int k = j->klo; k < j->khi; k++)
+		for (int t = 0; t < j->slices; t++) {
+			int * h = j->hist + (size_t) t * j->range + k;
+			int n = *h;
+			*h = (int) next;
+			next += n;
+		}
+}
+
+static void count_scatter(void * arg) {
+	COUNT_JOB * j = (COUNT_JOB *) arg;
+	const int * a = j->s->data;
+	int * hist = j->hist, min = j->min;
+	sample_region(j->s, j->lo, j->hi - 1);
+	for (int i = j->lo; i < j->hi; i++) {
+		int slot = hist[a[i] - min]++;
+		j->out[slot] = a[i];
+		j->c.swaps++;
+		event_emit(EV_MOVE, i, slot, 0);
+		sample_step(j->s, -1, i, -1);
+	}
+}
+
+static void count_copy(void * arg) {
+	COUNT_JOB * j = (COUNT_JOB *) arg;
+	SAMPLES * s = j->s;
+	if (!sample_events)
+		memcpy(s->data + j->lo, j->out + j->lo, (size_t)(j->hi - j->lo) * sizeof(int));
+	else for (int i = j->lo; i < j->hi; i++) {
+		s->data[i] = j->out[i];
+		sample_accessed(s, i, EV_IN_SCRATCH);
+		event_emit(EV_WRITE, i, j->out[i], EV_COUNTED);
+		sample_step(s, i, -1, -1);
+	}
+	j->c.swaps += j->hi - j->lo;
+}
+
+void sample_sort_count(SAMPLES * s) {
+	COUNT_JOB jobs[POOL_MAX_THREADS];
+	int slices = SAMPLE_SIZE / COUNT_GRAIN, min, max, t;
+	if (slices > pool_size()) slices = pool_size();
+	if (slices < 1) slices = 1;
+
+	title("COUNTING SORT");
+	memset(jobs, 0, sizeof(jobs));
+	for (t = 0; t < slices; t++) {
+		jobs[t].s = s;
+		jobs[t].lo = (int)((long long) SAMPLE_SIZE * t / slices);
+		jobs[t].hi = (int)((long long) SAMPLE_SIZE * (t + 1) / slices);
+	}
+	count_fork(jobs, slices, count_bounds);
+	min = jobs[0].min;
+	max = jobs[0].max;
+	for (t = 1; t < slices; t++) {
+		if (jobs[t].min < min) min = jobs[t].min;
+		if (jobs[t].max > max) max = jobs[t].max;
+	}
+	for (t = 0; t < slices; t++) counters_add(s, &jobs[t].c);
+
+	long range = (long) max - min + 1, cells = (long) COUNT_SPREAD * SAMPLE_SIZE;
+	if (cells < COUNT_RANGE_MIN) cells = COUNT_RANGE_MIN;
+	if (range > cells) {
+		sample_regions_clear(s);
+		sample_sort_radix(s);
+		return;
+	}
+	if (range > 1) {
+		/* wide ranges get fewer slices, the histograms stay within cells */
+		if (slices > cells / range) {
+			slices = (int)(cells / range);
+			for (t = 0; t < slices; t++) {
+				jobs[t].lo = (int)((long long) SAMPLE_SIZE * t / slices);
+				jobs[t].hi = (int)((long long) SAMPLE_SIZE * (t + 1) / slices);
+			}
+		}
+		int * hist = (int *) mem_alloc((size_t) slices * range * sizeof(int), USE_HUGE_PAGES);
+		int * out = (int *) scratch_get((size_t) SAMPLE_SIZE * sizeof(int), USE_HUGE_PAGES);
+		if (!hist || !out) die(1, "Error: Out of memory for counting sort\n");
+		sample_aux(s, SAMPLE_SIZE + slices * (int) range);
+		for (t = 0; t < slices; t++) {
+			COUNT_JOB j = { s, hist + (size_t) t * range, out, jobs[t].lo, jobs[t].hi,
+							(int)(range * t / slices), (int)(range * (t + 1) / slices),
+							min, max, (int) range, slices, 0, { 0, 0 } };
+			jobs[t] = j;
+		}
+		count_fork(jobs, slices, count_histogram);
+
+		/* prefix sum: block totals in parallel, their scan, then offsets */
+		for (t = 0; t < slices; t++) jobs[t].hist = hist;
+		count_fork(jobs, slices, count_total);
+		long next = 0;
+		for (t = 0; t < slices; t++) {
+			long n = jobs[t].base;
+			jobs[t].base = next;
+			next += n;
+		}
+		count_fork(jobs, slices, count_offsets);
+
+		for (t = 0; t < slices; t++) jobs[t].hist = hist + (size_t) t * range;
+		count_fork(jobs, slices, count_scatter);
+		count_fork(jobs, slices, count_copy);
+		for (t = 0; t < slices; t++) counters_add(s, &jobs[t].c);
+		mem_free(hist);
+	}
+	sample_regions_clear(s);
+	sample_frame(s, -1, -1, -1);
+}
+
+/*---- NETWORK SORT ------------------------*/
+/* Bitonic sorting network. Recorded runs show every comparator of the
+   network for any n; unrecorded runs sort blocks of NET_BLOCK_MAX with the
+   fastest kernel and merge them bottom-up with the kernel's merge. */
+static void network_compare(SAMPLES * s, int i, int j, bool up) {
+	sample_compared(s, i, j);
+	if (up ? s->data[i] > s->data[j] : s->data[i] < s->data[j]) sample_swap(s, i, j);
+	sample_step(s, i, j, -1);
+}
+
+static void network_merge(SAMPLES * s, int lo, int n, bool up) {
+	if (n < 2) return;
+	int m = 1;
+	while (m < n - m) m <<= 1;				/* largest power of two below n */
+	sample_bounds(s, lo, lo + n - 1);
+	for (int i = lo; i < lo + n - m; i++)
+		network_compare(s, i, i + m, up);
+	network_merge(s, lo, m, up);
+	network_merge(s, lo + m, n - m, up);
+}
+
+static void network_sort(SAMPLES * s, int lo, int n, bool up) {
+	if (n < 2) return;
+	int m = n / 2;
+	network_sort(s, lo, m, !up);
+	network_sort(s, lo + m, n - m, up);
+	network_merge(s, lo, n, up);
+}
+
+static void network_blocks(SAMPLES * s) {
+	const NET_KERNEL * k = net_kernel();
+	int * src = s->data, * dst, lo, w;
+
+	for (lo = 0; lo < SAMPLE_SIZE; lo += NET_BLOCK_MAX)
+		sample_network_block(s, lo, SAMPLE_SIZE - lo < NET_BLOCK_MAX ? SAMPLE_SIZE - lo : NET_BLOCK_MAX);
+	if (SAMPLE_SIZE <= NET_BLOCK_MAX) return;
+
+	int * tmp = (int *) mem_alloc((size_t) SAMPLE_SIZE * sizeof(int), USE_HUGE_PAGES);
+	if (!tmp) die(1, "Error: Out of memory for network sort\n");
+	sample_aux(s, SAMPLE_SIZE);
+	dst = tmp;
+	for (w = NET_BLOCK_MAX; w < SAMPLE_SIZE; w <<= 1) {
+		for (lo = 0; lo < SAMPLE_SIZE; lo += 2 * w) {
+			int mid = lo + w < SAMPLE_SIZE ? lo + w : SAMPLE_SIZE;
+			int hi = lo + 2 * w < SAMPLE_SIZE ? lo + 2 * w : SAMPLE_SIZE;
+			k->merge(src + lo, mid - lo, src + mid, hi - mid, dst + lo);
+		}
+		/* a merge pass counts one comparison and one write per sample */
+		s->comparisons += SAMPLE_SIZE;
+		s->swaps += SAMPLE_SIZE;
+		int * t = src; src = dst; dst = t;
+	}
+	if (src != s->data) memcpy(s->data, src, (size_t) SAMPLE_SIZE * sizeof(int));
+	mem_free(tmp);
+}
+
+void sample_sort_network(SAMPLES * s) {
+	title("NETWORK SORT");
+	if (sample_events) network_sort(s, 0, SAMPLE_SIZE, true);
+	else network_blocks(s);
+	sample_bounds(s, -1, -1);
+	sample_frame(s, -1, -1, -1);
+}
+
+/*---- TIM SORT ----------------------------*/
+/* Natural merge sort after Timsort. Ascending and strictly descending runs
+   are found and the descending ones reversed, runs shorter than a minimum
+   are extended with binary insertion, and runs are merged under the stack
+   invariants so merges stay balanced. A merge that keeps taking from the
+   same run switches to galloping, which copies whole stretches after an
+   exponential search. Sorted input is a single run and costs n - 1
+   comparisons. The runs on the merge stack are drawn in region colors. */
+#define	TIM_MIN_MERGE		16		/* below this one run is extended over everything */
+#define	TIM_MIN_GALLOP		7		/* wins in a row before galloping */
+#define	TIM_STACK			85		/* runs pending, enough for 2^64 samples */
+
+typedef struct tim {
+	SAMPLES *	s;
+	int *		tmp;				/* the smaller run of a merge */
+	int			min_gallop;
+	int			runs;
+	int			base[TIM_STACK], len[TIM_STACK];
+} TIM;
+
+static int tim_index(TIM * t, const int * p) {
+	/* index of p in the samples for the events, -1 for a value in scratch
+	   memory after reporting its load */
+	if (p >= t->tmp && p < t->tmp + SAMPLE_SIZE / 2 + 1) {
+		sample_accessed(t->s, (int)(p - t->tmp), EV_IN_SCRATCH);
+		return -1;
+	}
+	return (int)(p - t->s->data);
+}
+
+static bool tim_less(TIM * t, const int * x, const int * y) {
+	/* either may sit in the samples or in scratch memory */
+	int i = tim_index(t, x), j = tim_index(t, y);
+	sample_compared(t->s, i, j);
+	return *x < *y;
+}
+
+static void tim_put(TIM * t, int i, int v) {
+	sample_write(t->s, i, v);
+	sample_step(t->s, i, -1, -1);
+}
+
+static void tim_move(TIM * t, int dst, int src, int n) {
+	/* overlapping moves inside the samples, like memmove */
+	if (dst < src) for (int k = 0; k < n; k++) {
+		sample_accessed(t->s, src + k, 0);
+		tim_put(t, dst + k, t->s->data[src + k]);
+	}
+	else for (int k = n - 1; k >= 0; k--) {
+		sample_accessed(t->s, src + k, 0);
+		tim_put(t, dst + k, t->s->data[src + k]);
+	}
+}
+
+static void tim_copy(TIM * t, int dst, const int * src, int n) {
+	/* from scratch memory back into the samples */
+	for (int k = 0; k < n; k++) {
+		sample_accessed(t->s, (int)(src + k - t->tmp), EV_IN_SCRATCH);
+		tim_put(t, dst + k, src[k]);
+	}
+}
+
+static void tim_show(TIM * t) {
+	/* the top runs of the stack, one color each */
+	int first = t->runs > REGION_COUNT ? t->runs - REGION_COUNT : 0;
+	for (int r = 0; r < REGION_COUNT; r++) {
+		int i = first + r;
+		if (i < t->runs) sample_region_at(t->s, i % REGION_COUNT, t->base[i], t->base[i] + t->len[i] - 1);
+		else if (t->s->region[i % REGION_COUNT].lo >= 0) sample_region_at(t->s, i % REGION_COUNT, -1, -1);
+	}
+}
+
+static int tim_min_run(int n) {
+	/* n / min run is a power of two or just below, min run is
+	   TIM_MIN_MERGE / 2 up to TIM_MIN_MERGE */
+	int r = 0;
+	while (n >= TIM_MIN_MERGE) {
+		r |= n & 1;
+		n >>= 1;
+	}
+	return n + r;
+}
+
+static int tim_count_run(TIM * t, int lo, int hi) {
+	/* length of the run starting at lo, hi excluded, made ascending */
+	int * a = t->s->data, i = lo + 1;
+	if (i == hi) return 1;
+	sample_compared(t->s, i, lo);
+	if (a[i] < a[lo]) {
+		while (++i < hi && (sample_compared(t->s, i, i - 1), a[i] < a[i - 1])) ;
+		for (int l = lo, r = i - 1; l < r; l++, r--) {
+			sample_swap(t->s, l, r);
+			sample_step(t->s, l, r, -1);
+		}
+	}
+	else while (++i < hi && (sample_compared(t->s, i, i - 1), a[i] >= a[i - 1])) ;
+	return i - lo;
+}
+
+static void tim_binary_insertion(TIM * t, int lo, int hi, int start) {
+	/* lo..start-1 is sorted, inserts start..hi-1 with binary searches */
+	int * a = t->s->data;
+	for (int i = start; i < hi; i++) {
+		int key = a[i], l = lo, r = i;
+		while (l < r) {
+			int m = (l + r) >> 1;
+			sample_compared(t->s, m, -1);
+			if (key < a[m]) r = m; else l = m + 1;
+		}
+		for (int k = i; k > l; k--) tim_put(t, k, a[k - 1]);
+		sample_place(t->s, l, key);
+		sample_step(t->s, i, l, -1);
+	}
+}
+
+/* Where key goes in the sorted a[0..n-1], before equal values, searching
+   outwards from hint first */
+static int tim_gallop_left(TIM * t, const int * key, const int * a, int n, int hint) {
+	int last = 0, ofs = 1, m;
+	if (tim_less(t, a + hint, key)) {
+		int max = n - hint;
+		while (ofs < max && tim_less(t, a + hint + ofs, key)) {
+			last = ofs;
+			ofs = (ofs << 1) + 1;
+			if (ofs <= 0) ofs = max;
+		}
+		if (ofs > max) ofs = max;
+		last += hint;
+		ofs += hint;
+	} else {
+		int max = hint + 1;
+		while (ofs < max && !tim_less(t, a + hint - ofs, key)) {
+			last = ofs;
+			ofs = (ofs << 1) + 1;
+			if (ofs <= 0) ofs = max;
+		}
+		if (ofs > max) ofs = max;
+		m = last;
+		last = hint - ofs;
+		ofs = hint - m;
+	}
+	for (last++; last < ofs; ) {
+		m = last + ((ofs - last) >> 1);
+		if (tim_less(t, a + m, key)) last = m + 1; else ofs = m;
+	}
+	return ofs;
+}
+
+/* Same, after equal values */
+static int tim_gallop_right(TIM * t, const int * key, const int * a, int n, int hint) {
+	int last = 0, ofs = 1, m;
+	if (tim_less(t, key, a + hint)) {
+		int max = hint + 1;
+		while (ofs < max && tim_less(t, key, a + hint - ofs)) {
+			last = ofs;
+			ofs = (ofs << 1) + 1;
+			if (ofs <= 0) ofs = max;
+		}
+		if (ofs > max) ofs = max;
+		m = last;
+		last = hint - ofs;
+		ofs = hint - m;
+	} else {
+		int max = n - hint;
+		while (ofs < max && !tim_less(t, key, a + hint + ofs)) {
+			last = ofs;
+			ofs = (ofs << 1) + 1;
+			if (ofs <= 0) ofs = max;
+		}
+		if (ofs > max) ofs = max;
+		last += hint;
+		ofs += hint;
+	}
+	for (last++; last < ofs; ) {
+		m = last + ((ofs - last) >> 1);
+		if (tim_less(t, key, a + m)) ofs = m; else last = m + 1;
+	}
+	return ofs;
+}
+
+static void tim_merge_lo(TIM * t, int base1, int len1, int base2, int len2) {
+	/* len1 <= len2: the first run goes to scratch, merging forwards */
+	int * a = t->s->data, * tmp = t->tmp;
+	int c1 = 0, c2 = base2, dest = base1, min_gallop = t->min_gallop;
+
+	memcpy(tmp, a + base1, (size_t) len1 * sizeof(int));
+	tim_put(t, dest++, a[c2++]);
+	if (--len2 == 0) { tim_copy(t, dest, tmp + c1, len1); return; }
+	if (len1 == 1) { tim_move(t, dest, c2, len2); tim_put(t, dest + len2, tmp[c1]); return; }
+
+	for (;;) {
+		int count1 = 0, count2 = 0;
+		/* one at a time until a run wins min_gallop times in a row */
+		do {
+			if (tim_less(t, a + c2, tmp + c1)) {
+				tim_put(t, dest++, a[c2++]);
+				count2++; count1 = 0;
+				if (--len2 == 0) goto done;
+			} else {
+				tim_put(t, dest++, tmp[c1++]);
+				count1++; count2 = 0;
+				if (--len1 == 1) goto done;
+			}
+		} while ((count1 | count2) < min_gallop);
+		/* then gallop while that keeps paying off */
+		do {
+			count1 = tim_gallop_right(t, a + c2, tmp + c1, len1, 0);
+			if (count1) {
+				tim_copy(t, dest, tmp + c1, count1);
+				dest += count1; c1 += count1; len1 -= count1;
+				if (len1 <= 1) goto done;
+			}
+			tim_put(t, dest++, a[c2++]);
+			if (--len2 == 0) goto done;
+			count2 = tim_gallop_left(t, tmp + c1, a + c2, len2, 0);
+			if (count2) {
+				tim_move(t, dest, c2, count2);
+				dest += count2; c2 += count2; len2 -= count2;
+				if (len2 == 0) goto done;
+			}
+			tim_put(t, dest++, tmp[c1++]);
+			if (--len1 == 1) goto done;
+			min_gallop--;
+		} while (count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
+		if (min_gallop < 0) min_gallop = 0;
+		min_gallop += 2;				/* leaving gallop mode costs */
+	}
+done:
+	t->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+	if (len1 == 1) {
+		tim_move(t, dest, c2, len2);
+		tim_put(t, dest + len2, tmp[c1]);
+	}
+	else tim_copy(t, dest, tmp + c1, len1);
+}
+
+static void tim_merge_hi(TIM * t, int base1, int len1, int base2, int len2) {
+	/* len1 > len2: the second run goes to scratch, merging backwards */
+	int * a = t->s->data, * tmp = t->tmp;
+	int c1 = base1 + len1 - 1, c2 = len2 - 1, dest = base2 + len2 - 1, min_gallop = t->min_gallop;
+
+	memcpy(tmp, a + base2, (size_t) len2 * sizeof(int));
+	tim_put(t, dest--, a[c1--]);
+	if (--len1 == 0) { tim_copy(t, dest - (len2 - 1), tmp, len2); return; }
+	if (len2 == 1) {
+		dest -= len1; c1 -= len1;
+		tim_move(t, dest + 1, c1 + 1, len1);
+		tim_put(t, dest, tmp[c2]);
+		return;
+	}
+
+	for (;;) {
+		int count1 = 0, count2 = 0;
+		do {
+			if (tim_less(t, tmp + c2, a + c1)) {
+				tim_put(t, dest--, a[c1--]);
+				count1++; count2 = 0;
+				if (--len1 == 0) goto done;
+			} else {
+				tim_put(t, dest--, tmp[c2--]);
+				count2++; count1 = 0;
+				if (--len2 == 1) goto done;
+			}
+		} while ((count1 | count2) < min_gallop);
+		do {
+			count1 = len1 - tim_gallop_right(t, tmp + c2, a + base1, len1, len1 - 1);
+			if (count1) {
+				dest -= count1; c1 -= count1; len1 -= count1;
+				tim_move(t, dest + 1, c1 + 1, count1);
+				if (len1 == 0) goto done;
+			}
+			tim_put(t, dest--, tmp[c2--]);
+			if (--len2 == 1) goto done;
+			count2 = len2 - tim_gallop_left(t, a + c1, tmp, len2, len2 - 1);
+			if (count2) {
+				dest -= count2; c2 -= count2; len2 -= count2;
+				tim_copy(t, dest + 1, tmp + c2 + 1, count2);
+				if (len2 <= 1) goto done;
+			}
+			tim_put(t, dest--, a[c1--]);
+			if (--len1 == 0) goto done;
+			min_gallop--;
+		} while (count1 >= TIM_MIN_GALLOP || count2 >= TIM_MIN_GALLOP);
+		if (min_gallop < 0) min_gallop = 0;
+		min_gallop += 2;
+	}
+done:
+	t->min_gallop = min_gallop < 1 ? 1 : min_gallop;
+	if (len2 == 1) {
+		dest -= len1; c1 -= len1;
+		tim_move(t, dest + 1, c1 + 1, len1);
+		tim_put(t, dest, tmp[c2]);
+	}
+	else tim_copy(t, dest - (len2 - 1), tmp, len2);
+}
+
+static void tim_merge_at(TIM * t, int i) {
+	/* merges runs i and i + 1 of the stack */
+	int base1 = t->base[i], len1 = t->len[i], base2 = t->base[i + 1], len2 = t->len[i + 1];
+	int * a = t->s->data;
+
+	t->len[i] = len1 + len2;
+	if (i == t->runs - 3) {
+		t->base[i + 1] = t->base[i + 2];
+		t->len[i + 1] = t->len[i + 2];
+	}
+	t->runs--;
+	sample_bounds(t->s, base1, base2 + len2 - 1);
+
+	/* the start of run 1 and the end of run 2 may already be in place */
+	int k = tim_gallop_right(t, a + base2, a + base1, len1, 0);
+	base1 += k;
+	len1 -= k;
+	if (len1 > 0) {
+		len2 = tim_gallop_left(t, a + base1 + len1 - 1, a + base2, len2, len2 - 1);
+		if (len2 > 0) {
+			if (len1 <= len2) tim_merge_lo(t, base1, len1, base2, len2);
+			else tim_merge_hi(t, base1, len1, base2, len2);
+		}
+	}
+	tim_show(t);
+}
+
+static void tim_collapse(TIM * t) {
+	/* restores len[i-2] > len[i-1] + len[i] and len[i-1] > len[i] */
+	while (t->runs > 1) {
+		int n = t->runs - 2;
+		if ((n > 0 && t->len[n - 1] <= t->len[n] + t->len[n + 1]) ||
+			(n > 1 && t->len[n - 2] <= t->len[n] + t->len[n - 1])) {
+			if (t->len[n - 1] < t->len[n + 1]) n--;
+		}
+		else if (t->len[n] > t->len[n + 1]) break;
+		tim_merge_at(t, n);
+	}
+}
+
+void sample_sort_tim(SAMPLES * s) {
+	TIM t;
+	int lo = 0, left = SAMPLE_SIZE, min_run = tim_min_run(SAMPLE_SIZE);
+
+	title("TIM SORT");
+	t.s = s;
+	t.runs = 0;
+	t.min_gallop = TIM_MIN_GALLOP;
+	t.tmp = (int *) mem_alloc((size_t)(SAMPLE_SIZE / 2 + 1) * sizeof(int), USE_HUGE_PAGES);
+	if (!t.tmp) die(1, "Error: Out of memory for tim sort\n");
+	sample_aux(s, SAMPLE_SIZE / 2 + 1);
+
+	while (left > 0) {
+		int run = tim_count_run(&t, lo, SAMPLE_SIZE);
+		if (run < min_run) {
+			int force = left < min_run ? left : min_run;
+			tim_binary_insertion(&t, lo, lo + force, lo + run);
+			run = force;
+		}
+		t.base[t.runs] = lo;
+		t.len[t.runs++] = run;
+		tim_show(&t);
+		tim_collapse(&t);
+		lo += run;
+		left -= run;
+	}
+	while (t.runs > 1) {
+		int n = t.runs - 2;
+		if (n > 0 && t.len[n - 1] < t.len[n + 1]) n--;
+		tim_merge_at(&t, n);
+	}
+
+	mem_free(t.tmp);
+	sample_regions_clear(s);
+	sample_bounds(s, -1, -1);
+	sample_frame(s, -1, -1, -1);
+}
+
+/*---- D-ARY HEAP SORT ---------------------*/
+/* Iterative heap sort with HEAP_ARITY children per node. Sift-down is
+   Floyd's bottom-up one: the hole walks the larger children down to a
+   leaf without looking at the sifted value, which then bubbles back up a
+   level or two, about half the comparisons of checking at every level.
+   The heap starts HEAP_ARITY - 1 samples in, so with aligned samples every
+   group of children starts on a multiple of HEAP_ARITY ints and eight of
+   them never straddle a cache line; those first samples are the smallest,
+   picked out beforehand. Recorded runs color the levels of the tree. */
+int HEAP_ARITY = 4;					/* --heap-arity: 2, 4 or 8 */
+
+typedef struct dheap {
+	SAMPLES *	s;
+	int *		a;					/* heap root, s->data + base */
+	int			base;				/* samples in front of the heap */
+	int			d;
+} DHEAP;
+
+static void dheap_levels(DHEAP * h, int n) {
+	/* one region per tree level of the first n nodes */
+	long long first = 0, width = 1;		/* d^level passes int at 2^29 nodes */
+	for (int level = 0; level < REGION_COUNT; level++) {
+		if (first < n) {
+			int last = (first + width < n) ? (int)(first + width - 1) : n - 1;
+			sample_region_at(h->s, level, h->base + (int) first, h->base + last);
+		}
+		else if (h->s->region[level].lo >= 0) sample_region_at(h->s, level, -1, -1);
+		first += width;
+		width = (width > n) ? width : width * h->d;
+	}
+}
+
+static void dheap_sift(DHEAP * h, int i, int n) {
+	/* sifts the value at node i of the first n nodes down */
+	int * a = h->a, d = h->d, base = h->base, v = a[i], top = i;
+	for (long long first; (first = (long long) d * i + 1) < n; ) {
+		int c = (int) first, end = (c + d < n) ? c + d : n;
+		for (int k = c + 1; k < end; k++) {
+			sample_compared(h->s, base + k, base + c);
+			if (a[k] > a[c]) c = k;
+		}
+		sample_write(h->s, base + i, a[c]);
+		sample_step(h->s, base + i, base + c, -1);
+		i = c;
+	}
+	while (i > top) {
+		int p = (i - 1) / d;
+		sample_compared(h->s, base + p, -1);
+		if (a[p] >= v) break;
+		sample_write(h->s, base + i, a[p]);
+		sample_step(h->s, base + i, base + p, -1);
+		i = p;
+	}
+	sample_place(h->s, base + i, v);
+}
+
+static void dheap_prefix(SAMPLES * s, int k) {
+	/* moves the k smallest samples to the front, sorted */
+	int * a = s->data;
+	for (int i = 0; i < SAMPLE_SIZE; i++) {
+		int j = (i < k) ? i : k - 1;
+		if (i >= k) {
+			sample_compared(s, i, k - 1);
+			if (a[i] >= a[k - 1]) continue;
+			sample_swap(s, i, k - 1);
+		}
+		for (; j > 0; j--) {
+			sample_compared(s, j - 1, j);
+			if (a[j - 1] <= a[j]) break;
+			sample_swap(s, j - 1, j);
+		}
+		sample_step(s, i, j, -1);
+	}
+}
+
+void sample_sort_dheap(SAMPLES * s) {
+	DHEAP h = { s, s->data, HEAP_ARITY - 1, HEAP_ARITY };
+	int n = SAMPLE_SIZE - h.base;
+
+	title("D-ARY HEAP SORT");
+	if (n <= 0) h.base = SAMPLE_SIZE;
+	dheap_prefix(s, h.base);
+	h.a = s->data + h.base;
+	sample_bounds(s, h.base, SAMPLE_SIZE - 1);
+	if (sample_events) dheap_levels(&h, n);
+
+	for (int i = (n - 2) / h.d; n > 1 && i >= 0; i--)
+		dheap_sift(&h, i, n);
+	for (int end = n - 1; end > 0; end--) {
+		sample_swap(s, h.base, h.base + end);
+		if (sample_events) dheap_levels(&h, end);
+		dheap_sift(&h, 0, end);
+	}
+
+	sample_regions_clear(s);
+	sample_bounds(s, -1, -1);
+	sample_frame(s, -1, -1, -1);
+}
+
+/*---- ALGORITHM REGISTRY ------------------*/
+void sample_sort_merge_all(SAMPLES * s) { sample_sort_merge(s, 0, SAMPLE_SIZE-1); }
+void sample_sort_quick_all(SAMPLES * s) { sample_sort_quick(s, 0, SAMPLE_SIZE-1); }
+
+/* sample layouts, used to flag the inputs an algorithm is quadratic on */
+#define	LAYOUT_RANDOM		0x01
+#define	LAYOUT_ASCENDING	0x02
+#define	LAYOUT_DESCENDING	0x04
+#define	LAYOUT_ALL			0x07
+
+typedef struct algorithm {
+	char		key;				/* main menu letter */
+	const char *name;				/* short name used in reports */
+	const char *label;				/* main menu entry */
+	void		(*sort)(SAMPLES *);
+	unsigned	worst;				/* LAYOUT_* inputs that take quadratic time */
+} ALGORITHM;
+
+/* Letters N to Q and X belong to the menu commands */
+const ALGORITHM ALGORITHMS[] = {
+	{ 'A', "interchange", "Interchange Sort",    sample_sort_interchange,    LAYOUT_ALL                           },
+	{ 'B', "bubble",      "Bubble Sort",         sample_sort_bubble,         LAYOUT_RANDOM | LAYOUT_DESCENDING    },
+	{ 'C', "cocktail",    "Cocktail Sort",       sample_sort_cocktail,       LAYOUT_RANDOM | LAYOUT_DESCENDING    },
+	{ 'D', "selection",   "Selection Sort",      sample_sort_selection,      LAYOUT_ALL                           },
+	{ 'E', "insertion",   "Insertion Sort",      sample_sort_insertion,      LAYOUT_RANDOM | LAYOUT_DESCENDING    },
+	{ 'F', "shell",       "Shell Sort",          sample_sort_shell,          0                                    },
+	{ 'G', "comb",        "Comb Sort",           sample_sort_comb,           0                                    },
+	{ 'H', "merge",       "Merge Sort",          sample_sort_merge_all,      0                                    },
+	{ 'I', "heap",        "Heap Sort",           sample_sort_heap,           0                                    },
+	{ 'J', "counting",    "Counting Sort",       sample_sort_count,          0                                    },
+	{ 'K', "quick",       "Quick Sort",          sample_sort_quick_all,      0                                    },
+	{ 'L', "radix",       "Radix Sort",          sample_sort_radix,          0                                    },
+	{ 'M', "circle",      "Circle Sort",         sample_sort_circle,         0                                    },
+	{ 'R', "pmerge",      "Parallel Merge",      sample_sort_merge_parallel, 0                                    },
+	{ 'S', "pquick",      "Parallel Quick",      sample_sort_quick_parallel, 0                                    },
+	{ 'T', "network",     "Network Sort",        sample_sort_network,        0                                    },
+	{ 'U', "tim",         "Tim Sort",            sample_sort_tim,            0                                    },
+	{ 'V', "dheap",       "D-ary Heap Sort",     sample_sort_dheap,          0                                    },
+	{ 'W', "block",       "Block Quick Sort",    sample_sort_quick_block,    0                                    },
+};
+#define	ALGORITHM_COUNT	(int)(sizeof(ALGORITHMS) / sizeof(ALGORITHMS[0]))
+
+#endif
@@ -0,0 +1,1369 @@
+#ifndef __SORTVIS_BENCH__
+#define __SORTVIS_BENCH__
+
+#include <stdarg.h>
+
+/*---- HEADLESS BENCHMARK ------------------*/
+#define	BENCH_QUADRATIC_LIMIT	(1 << 15)	/* skip O(n^2) runs above this size */
+
+bool BENCH_MODE = false;			/* run every algorithm without the terminal and exit */
+bool BENCH_PICKED[ALGORITHM_COUNT];	/* algorithms named with --algs */
+bool BENCH_FILTER = false;			/* true when --algs was given */
+
+int algorithm_find(const char * name, size_t len) {
+	for (int a = 0; a < ALGORITHM_COUNT; a++)
+		if (strlen(ALGORITHMS[a].name) == len && strncmp(ALGORITHMS[a].name, name, len) == 0)
+			return a;
+	return -1;
+}
+
+/* Parses a comma separated list of algorithm names for --algs.
+   Returns false on the first unknown name. */
+bool bench_select(const char * list) {
+	const char * p = list;
+	BENCH_FILTER = true;
+	while (*p) {
+		size_t len = strcspn(p, ",");
+		int a = algorithm_find(p, len);
+		if (a < 0) {
+			fprintf(stderr, "Error: Unknown algorithm '%.*s'\n", (int) len, p);
+			return false;
+		}
+		BENCH_PICKED[a] = true;
+		p += len;
+		if (*p == ',') p++;
+	}
+	return true;
+}
+
+bool bench_wanted(int a, int d) {
+	if (BENCH_FILTER && !BENCH_PICKED[a]) return false;
+	/* quadratic runs on large inputs would dominate the whole table */
+	if (SAMPLE_SIZE > BENCH_QUADRATIC_LIMIT && (ALGORITHMS[a].worst & DISTRIBUTIONS[d].layout)) {
+		fprintf(stderr, "Note: skipping %s on %s samples (quadratic above %d)\n",
+				ALGORITHMS[a].name, DISTRIBUTIONS[d].name, BENCH_QUADRATIC_LIMIT);
+		return false;
+	}
+	return true;
+}
+
+/*---- REPEATED RUNS -----------------------*/
+/* --repeat times every sort several times, each on a fresh copy of the
+   same samples, after --warmup runs that are not timed. The table then
+   holds the median time with the 10th and 90th percentiles and the median
+   absolute deviation, which a run spoiled by a context switch barely
+   moves. Counters come from the last run. */
+#define	BENCH_REPEAT_MAX	1000
+
+int BENCH_REPEAT = 1;				/* --repeat: timed runs per sort */
+int BENCH_WARMUP = -1;				/* --warmup: untimed runs first, -1 for one when repeating */
+
+typedef struct bench_stats {
+	double		median, p10, p90, mad;
+} BENCH_STATS;
+
+static int bench_order(const void * a, const void * b) {
+	double x = *(const double *) a, y = *(const double *) b;
+	return (x > y) - (x < y);
+}
+
+static double bench_quantile(const double * sorted, int n, double q) {
+	/* interpolated between the two closest ranks */
+	double at = q * (n - 1);
+	int i = (int) at;
+	return (i + 1 < n) ? sorted[i] + (at - i) * (sorted[i + 1] - sorted[i]) : sorted[n - 1];
+}
+
+BENCH_STATS bench_stats(const double * times, int n) {
+	double sorted[BENCH_REPEAT_MAX], dev[BENCH_REPEAT_MAX];
+	BENCH_STATS st;
+	memcpy(sorted, times, (size_t) n * sizeof(double));
+	qsort(sorted, (size_t) n, sizeof(double), bench_order);
+	st.median = bench_quantile(sorted, n, 0.5);
+	st.p10 = bench_quantile(sorted, n, 0.1);
+	st.p90 = bench_quantile(sorted, n, 0.9);
+	for (int i = 0; i < n; i++) dev[i] = fabs(sorted[i] - st.median);
+	qsort(dev, (size_t) n, sizeof(double), bench_order);
+	st.mad = bench_quantile(dev, n, 0.5);
+	return st;
+}
+
+/*---- OUTPUT FORMATS ----------------------*/
+/* The --bench table is tab or comma separated text, or a JSON array of
+   one object per row, the form --compare reads back. Rows are built one
+   field at a time and the text header is taken from the first row. */
+enum { FORMAT_TSV, FORMAT_CSV, FORMAT_JSON, FORMAT_COUNT };
+const char * BENCH_FORMATS[FORMAT_COUNT] = { "tsv", "csv", "json" };
+
+int BENCH_FORMAT = FORMAT_TSV;		/* --format */
+
+static char	benchHead[4096];
+static char	benchLine[8 * BENCH_REPEAT_MAX + 4096];
+static int	benchRows, benchFields;
+
+bool bench_format(const char * name) {
+	for (int f = 0; f < FORMAT_COUNT; f++)
+		if (strcmp(name, BENCH_FORMATS[f]) == 0) {
+			BENCH_FORMAT = f;
+			return true;
+		}
+	return false;
+}
+
+static void bench_append(char * buf, size_t cap, const char * fmt, ...) {
+	size_t len = strlen(buf);
+	va_list ap;
+	va_start(ap, fmt);
+	vsnprintf(buf + len, cap - len, fmt, ap);
+	va_end(ap);
+}
+
+static void bench_field(const char * name, const char * value, bool text) {
+	const char * sep = (BENCH_FORMAT == FORMAT_JSON) ? ", " : (BENCH_FORMAT == FORMAT_CSV) ? "," : "\t";
+	if (benchFields++) bench_append(benchLine, sizeof(benchLine), "%s", sep);
+	if (BENCH_FORMAT == FORMAT_JSON) {
+		if (!text && strcmp(value, "-") == 0) value = "null";
+		bench_append(benchLine, sizeof(benchLine), text ? "\"%s\": \"%s\"" : "\"%s\": %s", name, value);
+		return;
+	}
+	if (!benchRows) bench_append(benchHead, sizeof(benchHead), "%s%s", benchFields > 1 ? sep : "", name);
+	bench_append(benchLine, sizeof(benchLine), "%s", value);
+}
+
+void bench_text(const char * name, const char * value) {
+	bench_field(name, value, true);
+}
+
+void bench_num(const char * name, const char * fmt, ...) {
+	/* a value printed as "-" is missing, null in JSON */
+	char value[64];
+	va_list ap;
+	va_start(ap, fmt);
+	vsnprintf(value, sizeof(value), fmt, ap);
+	va_end(ap);
+	bench_field(name, value, false);
+}
+
+void bench_list(const char * name, const double * v, int n) {
+	/* every run time, JSON only */
+	char list[8 * BENCH_REPEAT_MAX + 64] = "[";
+	if (BENCH_FORMAT != FORMAT_JSON) return;
+	for (int i = 0; i < n; i++) bench_append(list, sizeof(list), i ? ", %.3f" : "%.3f", v[i]);
+	bench_append(list, sizeof(list), "]");
+	bench_field(name, list, false);
+}
+
+void bench_row_end() {
+	if (BENCH_FORMAT == FORMAT_JSON) printf("%s  { %s }", benchRows ? ",\n" : "[\n", benchLine);
+	else {
+		if (!benchRows) printf("%s\n", benchHead);
+		printf("%s\n", benchLine);
+	}
+	fflush(stdout);
+	benchRows++;
+	benchFields = 0;
+	benchLine[0] = '\0';
+}
+
+void bench_table_end() {
+	if (BENCH_FORMAT == FORMAT_JSON) printf(benchRows ? "\n]\n" : "[]\n");
+	benchRows = 0;
+}
+
+/*---- BASELINE COMPARISON -----------------*/
+/* --compare reads a table written with --format json and tests each row
+   against the row of the same algorithm, layout and size: a one sided
+   Mann-Whitney U test on the two sets of run times, normal approximation
+   with ties. A row regressed when its runs are slower at BENCH_ALPHA and
+   its median grew by more than BENCH_NOISE, and improved the other way
+   round. Rows with fewer than BENCH_COMPARE_RUNS runs on either side are
+   not judged. The reader only knows the JSON this program writes. */
+#define	BENCH_ALPHA			0.01
+#define	BENCH_NOISE			0.05		/* median changes never flagged */
+#define	BENCH_COMPARE_RUNS	5
+
+typedef struct baseline {
+	char		algorithm[32], distribution[32];
+	int			n, runs;
+	unsigned long long seed;
+	double		times[BENCH_REPEAT_MAX];
+} BASELINE;
+
+const char * BENCH_COMPARE = NULL;	/* --compare */
+
+static BASELINE *	baseline;
+static int			baselineCount;
+
+static const char * json_value(const char * obj, const char * key) {
+	/* the text after "key": in obj, NULL when it has no such key */
+	char quoted[40];
+	snprintf(quoted, sizeof(quoted), "\"%s\"", key);
+	const char * p = strstr(obj, quoted);
+	if (!p) return NULL;
+	p += strlen(quoted);
+	while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r' || *p == ':') p++;
+	return p;
+}
+
+static bool json_string(const char * obj, const char * key, char * out, size_t cap) {
+	const char * p = json_value(obj, key), * end;
+	if (!p || *p != '"' || !(end = strchr(p + 1, '"')) || (size_t)(end - p - 1) >= cap) return false;
+	memcpy(out, p + 1, (size_t)(end - p - 1));
+	out[end - p - 1] = '\0';
+	return true;
+}
+
+/* Loads the rows of a JSON table. Returns false if it can not be read. */
+bool bench_baseline(const char * path) {
+	FILE * f = fopen(path, "rb");
+	char * text, * obj, * end;
+	long size;
+	if (!f) return false;
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	rewind(f);
+	text = (char *) malloc((size_t) size + 1);
+	if (!text || size <= 0 || fread(text, 1, (size_t) size, f) != (size_t) size) {
+		free(text);
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+	text[size] = '\0';
+
+	for (obj = strchr(text, '{'); obj; obj = end ? strchr(end + 1, '{') : NULL) {
+		BASELINE * b;
+		const char * p;
+		if ((end = strchr(obj, '}'))) *end = '\0';		/* rows hold no nested objects */
+		b = (BASELINE *) realloc(baseline, (size_t)(baselineCount + 1) * sizeof(BASELINE));
+		if (!b) die(1, "Error: Out of memory for the baseline\n");
+		baseline = b;
+		b += baselineCount;
+		memset(b, 0, sizeof(*b));
+		if (!json_string(obj, "algorithm", b->algorithm, sizeof(b->algorithm)) ||
+			!json_string(obj, "distribution", b->distribution, sizeof(b->distribution)) ||
+			!(p = json_value(obj, "n")) || sscanf(p, "%d", &b->n) != 1 ||
+			!(p = json_value(obj, "times_ms")) || *p != '[')
+			continue;
+		if ((p = json_value(obj, "seed"))) b->seed = strtoull(p, NULL, 10);
+		p = json_value(obj, "times_ms") + 1;
+		while (b->runs < BENCH_REPEAT_MAX) {
+			char * next;
+			double t = strtod(p, &next);
+			if (next == p) break;
+			b->times[b->runs++] = t;
+			p = next;
+			while (*p == ',' || *p == ' ' || *p == '\n' || *p == '\r') p++;
+		}
+		baselineCount++;
+	}
+	free(text);
+	return baselineCount > 0;
+}
+
+static const BASELINE * baseline_find(const char * algorithm, const char * distribution, int n) {
+	for (int i = 0; i < baselineCount; i++)
+		if (baseline[i].n == n && strcmp(baseline[i].algorithm, algorithm) == 0 &&
+			strcmp(baseline[i].distribution, distribution) == 0)
+			return &baseline[i];
+	return NULL;
+}
+
+double mann_whitney(const double * a, int na, const double * b, int nb) {
+	/* one sided p-value of b running longer than a */
+	struct { double t; bool b; } all[2 * BENCH_REPEAT_MAX];
+	int n = na + nb;
+	double rank = 0, ties = 0;
+	for (int i = 0; i < na; i++) all[i].t = a[i], all[i].b = false;
+	for (int i = 0; i < nb; i++) all[na + i].t = b[i], all[na + i].b = true;
+	for (int i = 1; i < n; i++)		/* insertion sort, a few hundred runs at most */
+		for (int j = i; j > 0 && all[j - 1].t > all[j].t; j--) {
+			double t = all[j].t; bool f = all[j].b;
+			all[j].t = all[j - 1].t; all[j].b = all[j - 1].b;
+			all[j - 1].t = t; all[j - 1].b = f;
+		}
+	for (int i = 0, k; i < n; i = k) {
+		int inb = 0;
+		for (k = i; k < n && all[k].t == all[i].t; k++) inb += all[k].b;
+		rank += inb * (i + k + 1) / 2.0;	/* tied runs share their mean rank */
+		ties += (double)(k - i) * (k - i) * (k - i) - (k - i);
+	}
+	double u = rank - nb * (nb + 1) / 2.0, mean = na * (double) nb / 2;
+	double var = na * (double) nb / 12 * ((n + 1) - ties / ((double) n * (n - 1)));
+	if (var <= 0) return 1;
+	return 0.5 * erfc((u - mean - 0.5) / sqrt(var) / sqrt(2.0));
+}
+
+/* Adds the comparison columns of one row. Returns true on a regression. */
+static bool bench_verdict(const char * algorithm, const char * distribution, const double * times, int runs,
+						  double median) {
+	const BASELINE * b = baseline_find(algorithm, distribution, SAMPLE_SIZE);
+	const char * verdict = "same";
+	if (!b || !b->runs) {
+		bench_num("baseline_ms", "-");
+		bench_num("change", "-");
+		bench_num("p_value", "-");
+		bench_text("verdict", "new");
+		return false;
+	}
+	double base = bench_stats(b->times, b->runs).median;
+	double change = base > 0 ? median / base - 1 : 0;
+	double slower = mann_whitney(b->times, b->runs, times, runs);
+	double faster = mann_whitney(times, runs, b->times, b->runs);
+	if (runs < BENCH_COMPARE_RUNS || b->runs < BENCH_COMPARE_RUNS) verdict = "few runs";
+	else if (slower < BENCH_ALPHA && change > BENCH_NOISE) verdict = "regression";
+	else if (faster < BENCH_ALPHA && change < -BENCH_NOISE) verdict = "improvement";
+	bench_num("baseline_ms", "%.3f", base);
+	bench_num("change", BENCH_FORMAT == FORMAT_JSON ? "%.4f" : "%+.1f%%", BENCH_FORMAT == FORMAT_JSON ? change : 100 * change);
+	bench_num("p_value", "%.4f", slower);
+	bench_text("verdict", verdict);
+	if (b->seed && b->seed != gen_seed())
+		fprintf(stderr, "Note: the baseline of %s on %s samples used --seed %llu\n", algorithm, distribution, b->seed);
+	return strcmp(verdict, "regression") == 0;
+}
+
+/* Runs every algorithm on every distribution and prints the table to
+   stdout. Returns a non-zero exit code if any sort failed or, with
+   --compare, regressed. */
+int bench_run() {
+	SAMPLES origin, sort;
+	double times[BENCH_REPEAT_MAX];
+	int d, a, failures = 0, regressions = 0, rows = 0;
+	int warmup = BENCH_WARMUP < 0 ? (BENCH_REPEAT > 1) : BENCH_WARMUP;
+	bool spread = BENCH_REPEAT > 1 || BENCH_FORMAT == FORMAT_JSON;
+
+	ENABLE_VISUALIZATION = false;
+	if (BENCH_COMPARE && !bench_baseline(BENCH_COMPARE)) {
+		fprintf(stderr, "Error: Cannot read the benchmark table '%s'\n", BENCH_COMPARE);
+		return 1;
+	}
+	if (!sample_alloc(&origin) || !sample_alloc(&sort)) {
+		fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+		return 1;
+	}
+	fprintf(stderr, "Note: --seed %llu reproduces these samples\n", gen_seed());
+	if (LOCALITY_MODE || CACHE_MODE)
+		fprintf(stderr, "Note: the %s columns trace the animated sorts: no network base case, "
+				"radix sort scatters back into the samples\n",
+				LOCALITY_MODE && CACHE_MODE ? "locality and cache" : LOCALITY_MODE ? "locality" : "cache");
+
+	for (d = 0; d < DISTRIBUTION_COUNT; d++) {
+		if (!gen_wanted(d)) continue;
+		DISTRIBUTIONS[d].generate(&origin);
+		for (a = 0; a < ALGORITHM_COUNT; a++) {
+			if (!bench_wanted(a, d)) continue;
+			const char * alg = ALGORITHMS[a].name, * dist = DISTRIBUTIONS[d].name;
+
+			for (int r = -warmup; r < BENCH_REPEAT; r++) {
+				double start, elapsed;
+				sample_copy(&sort, &origin);			/* the same input every run */
+				perf_start();
+				start = mstime();
+				ALGORITHMS[a].sort(&sort);
+				elapsed = mstime() - start;
+				perf_stop(sort.hw);
+				if (r >= 0) times[r] = elapsed;
+			}
+			BENCH_STATS st = bench_stats(times, BENCH_REPEAT);
+
+			if (!sample_is_sorted(&sort)) {
+				fprintf(stderr, "Error: %s left %s samples unsorted\n", alg, dist);
+				failures++;
+			}
+			bench_text("algorithm", alg);
+			bench_num("n", "%d", SAMPLE_SIZE);
+			bench_text("distribution", dist);
+			bench_num("time_ms", "%.3f", st.median);
+			if (spread) {
+				bench_num("p10_ms", "%.3f", st.p10);
+				bench_num("p90_ms", "%.3f", st.p90);
+				bench_num("mad_ms", "%.3f", st.mad);
+				bench_num("runs", "%d", BENCH_REPEAT);
+			}
+			bench_num("comparisons", "%ld", sort.comparisons);
+			bench_num("swaps", "%ld", sort.swaps);
+			bench_num("aux_bytes", "%ld", sort.aux);
+			bench_num("moved_bytes", "%ld", sort.moved);
+			for (int k = 0; PERF_MODE && k < HW_COUNTERS; k++) {
+				if (sort.hw[k] < 0) bench_num(HW_NAMES[k], "-");
+				else bench_num(HW_NAMES[k], "%ld", sort.hw[k]);
+			}
+			if (LOCALITY_MODE) {
+				/* traced on a second run, the timed one goes at full speed;
+				   recorded runs are the animated sorts, see locality.h */
+				sample_copy(&sort, &origin);
+				locality_run(&ALGORITHMS[a], &sort);
+				for (int k = 0; k < LOC_COUNTERS; k++) bench_num(LOC_NAMES[k], "%ld", sort.loc[k]);
+			}
+			if (CACHE_MODE) {
+				sample_copy(&sort, &origin);
+				cache_run(&ALGORITHMS[a], &sort);
+				for (int k = 0; k < 2 * CACHE_LEVEL_COUNT; k++) bench_num(CACHE_NAMES[k], "%ld", sort.cache[k]);
+			}
+			if (BENCH_FORMAT == FORMAT_JSON) bench_num("seed", "%llu", gen_seed());
+			bench_list("times_ms", times, BENCH_REPEAT);
+			if (BENCH_COMPARE) regressions += bench_verdict(alg, dist, times, BENCH_REPEAT, st.median);
+			bench_row_end();
+			rows++;
+		}
+	}
+	bench_table_end();
+
+	if (BENCH_COMPARE)
+		fprintf(stderr, "Note: %d of %d rows regressed against %s\n", regressions, rows, BENCH_COMPARE);
+	sample_free(&sort);
+	sample_free(&origin);
+	return (failures || regressions) ? 1 : 0;
+}
+
+/*---- RENDER MICROBENCHMARK --------------*/
+bool BENCH_RENDER = false;			/* measure frame building instead of sorting */
+
+#define	BENCH_RENDER_MS		1000	/* time spent on each rendering path */
+
+/* Builds frames for SAMPLE_SIZE samples into memory, one random swap per
+   frame, and prints frames per second for the full and differential paths. */
+int bench_render() {
+	SAMPLES s;
+	FRAME f = { 0 };
+	double start, elapsed;
+	long frames, bytes;
+	bool diff = DIFF_RENDERING;
+	RNG r;
+
+#ifndef _WIN32
+	setlocale(LC_ALL, "");			/* glyphs are encoded like on screen */
+#endif
+	if (!sample_alloc(&s)) {
+		fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+		return 1;
+	}
+	sample_generate_random(&s);
+	rng_seed(&r, gen_base(), 0);
+	set_shades(SHADE_RAINBOW);
+	title("RENDER BENCHMARK");
+
+	printf("renderer\tn\tframes\tfps\tbytes_per_frame\n");
+	for (int mode = 0; mode < 2; mode++) {
+		DIFF_RENDERING = mode;
+		boardShown = false;
+		board_render(&f, &s, -1, -1, -1);
+
+		frames = bytes = 0;
+		start = mstime();
+		do {
+			for (int k = 0; k < 64; k++) {
+				int a = (int) rng_below(&r, SAMPLE_SIZE), b = (int) rng_below(&r, SAMPLE_SIZE);
+				sample_swap(&s, a, b);
+				board_render(&f, &s, a, b, -1);
+				bytes += f.len;
+			}
+			frames += 64;
+			elapsed = mstime() - start;
+		} while (elapsed < BENCH_RENDER_MS);
+
+		printf("%s\t%d\t%ld\t%.0f\t%.0f\n", mode ? "diff" : "full", SAMPLE_SIZE,
+			   frames, frames * 1000.0 / elapsed, (double) bytes / frames);
+	}
+
+	DIFF_RENDERING = diff;
+	free(f.buf);
+	sample_free(&s);
+	return 0;
+}
+
+/*---- THREAD SCALING ----------------------*/
+bool BENCH_THREADS = false;			/* speedup of the parallel sorts per thread count */
+
+#define	BENCH_THREADS_RUNS	3		/* best of, to damp scheduler noise */
+
+/* parallel algorithms and the serial version they are measured against */
+const char * BENCH_PARALLEL[][2] = {
+	{ "pmerge", "merge" },
+	{ "pquick", "quick" },
+};
+#define	BENCH_PARALLEL_COUNT	(int)(sizeof(BENCH_PARALLEL) / sizeof(BENCH_PARALLEL[0]))
+
+static double bench_best(const ALGORITHM * alg, SAMPLES * origin, SAMPLES * sort, bool * sorted) {
+	double best = 0;
+	for (int r = 0; r < BENCH_THREADS_RUNS; r++) {
+		sample_copy(sort, origin);
+		double start = mstime();
+		alg->sort(sort);
+		double elapsed = mstime() - start;
+		if (r == 0 || elapsed < best) best = elapsed;
+		*sorted = *sorted && sample_is_sorted(sort);
+	}
+	return best;
+}
+
+/* Times each parallel sort on random samples with 1 up to --threads (or
+   every online cpu) threads, next to its serial version. */
+int bench_threads() {
+	SAMPLES origin, sort;
+	int top = THREADS > 0 ? THREADS : cpu_count(), failures = 0;
+
+	ENABLE_VISUALIZATION = false;
+	if (!sample_alloc(&origin) || !sample_alloc(&sort)) {
+		fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+		return 1;
+	}
+	sample_generate_random(&origin);
+
+	printf("algorithm\tthreads\tn\ttime_ms\tspeedup\tsteals\n");
+	for (int p = 0; p < BENCH_PARALLEL_COUNT; p++) {
+		int par = algorithm_find(BENCH_PARALLEL[p][0], strlen(BENCH_PARALLEL[p][0]));
+		int ser = algorithm_find(BENCH_PARALLEL[p][1], strlen(BENCH_PARALLEL[p][1]));
+		if (BENCH_FILTER && !BENCH_PICKED[par]) continue;
+
+		bool sorted = true;
+		double serial = bench_best(&ALGORITHMS[ser], &origin, &sort, &sorted);
+		printf("%s\t1\t%d\t%.3f\t%.2f\t0\n", ALGORITHMS[ser].name, SAMPLE_SIZE, serial, 1.0);
+		for (int t = 1; t <= top; t++) {
+			pool_start(t);
+			long steals = pool_steals();
+			double elapsed = bench_best(&ALGORITHMS[par], &origin, &sort, &sorted);
+			printf("%s\t%d\t%d\t%.3f\t%.2f\t%ld\n", ALGORITHMS[par].name, t, SAMPLE_SIZE,
+				   elapsed, elapsed > 0 ? serial / elapsed : 0,
+				   (pool_steals() - steals) / BENCH_THREADS_RUNS);
+			fflush(stdout);
+		}
+		if (!sorted) {
+			fprintf(stderr, "Error: %s left samples unsorted\n", ALGORITHMS[par].name);
+			failures++;
+		}
+	}
+
+	pool_stop();
+	sample_free(&sort);
+	sample_free(&origin);
+	return failures ? 1 : 0;
+}
+
+/*---- NETWORK KERNELS ---------------------*/
+bool BENCH_SIMD = false;			/* cycles per element of the network kernels */
+
+#define	BENCH_SIMD_MS		200		/* time spent on each kernel and size */
+#define	BENCH_SIMD_ELEMS	(1 << 14)	/* working set, fits the L1 or L2 cache */
+
+static unsigned long long bench_cycles() {
+#ifdef NET_X86
+	return __rdtsc();
+#else
+	return 0;						/* no portable cycle counter, ns only */
+#endif
+}
+
+/* The branchy baseline the kernels replace */
+static void bench_insertion(int * a, int n) {
+	for (int i = 1; i < n; i++) {
+		int key = a[i], j = i - 1;
+		while (j >= 0 && a[j] > key) { a[j + 1] = a[j]; j--; }
+		a[j + 1] = key;
+	}
+}
+
+static const NET_KERNEL BENCH_BASELINE = { "insertion", bench_insertion, net_merge_scalar };
+
+typedef struct bench_clock {
+	double				ms;
+	unsigned long long	cycles;
+	long long			elems;
+} BENCH_CLOCK;
+
+/* Sorts every n-block of a fresh copy of src until BENCH_SIMD_MS passed.
+   With k NULL only the copies are timed, to be taken off the others. */
+static BENCH_CLOCK bench_kernel_sort(const NET_KERNEL * k, int n, int * work, const int * src) {
+	BENCH_CLOCK c = { 0, 0, 0 };
+	double start = mstime();
+	unsigned long long cycles = bench_cycles();
+	do {
+		memcpy(work, src, BENCH_SIMD_ELEMS * sizeof(int));
+		if (k) for (int b = 0; b < BENCH_SIMD_ELEMS; b += n) k->sort(work + b, n);
+		c.elems += BENCH_SIMD_ELEMS;
+		c.ms = mstime() - start;
+	} while (c.ms < BENCH_SIMD_MS);
+	c.cycles = bench_cycles() - cycles;
+	return c;
+}
+
+/* Merges the two sorted halves of src into work until BENCH_SIMD_MS passed */
+static BENCH_CLOCK bench_kernel_merge(const NET_KERNEL * k, int * work, const int * src) {
+	BENCH_CLOCK c = { 0, 0, 0 };
+	int half = BENCH_SIMD_ELEMS / 2;
+	double start = mstime();
+	unsigned long long cycles = bench_cycles();
+	do {
+		k->merge(src, half, src + half, half, work);
+		c.elems += BENCH_SIMD_ELEMS;
+		c.ms = mstime() - start;
+	} while (c.ms < BENCH_SIMD_MS);
+	c.cycles = bench_cycles() - cycles;
+	return c;
+}
+
+static void bench_kernel_print(const char * kernel, const char * op, int n, BENCH_CLOCK c, BENCH_CLOCK copy) {
+	double ns = c.ms * 1e6 / c.elems, cpe = (double) c.cycles / c.elems;
+	if (copy.elems) {
+		ns -= copy.ms * 1e6 / copy.elems;
+		cpe -= (double) copy.cycles / copy.elems;
+	}
+	if (bench_cycles()) printf("%s\t%s\t%d\t%.2f\t%.2f\n", kernel, op, n, cpe, ns);
+	else printf("%s\t%s\t%d\t-\t%.2f\n", kernel, op, n, ns);
+	fflush(stdout);
+}
+
+/* Prints cycles and nanoseconds per element of every kernel the cpu runs:
+   sorting random 8, 16 and 32 blocks next to insertion sort, and merging
+   two sorted runs. Cycles are time stamp counter ticks. */
+int bench_simd() {
+	int * src = (int *) mem_alloc(BENCH_SIMD_ELEMS * sizeof(int), false);
+	int * runs = (int *) mem_alloc(BENCH_SIMD_ELEMS * sizeof(int), false);
+	int * work = (int *) mem_alloc(BENCH_SIMD_ELEMS * sizeof(int), false);
+	int failures = 0;
+	RNG r;
+
+	if (!src || !runs || !work) {
+		fprintf(stderr, "Error: Cannot allocate kernel benchmark buffers\n");
+		return 1;
+	}
+	rng_seed(&r, gen_base(), 0);
+	for (int i = 0; i < BENCH_SIMD_ELEMS; i++) src[i] = runs[i] = (int)(rng_next(&r) >> 33);
+	bench_insertion(runs, BENCH_SIMD_ELEMS / 2);
+	bench_insertion(runs + BENCH_SIMD_ELEMS / 2, BENCH_SIMD_ELEMS / 2);
+
+	printf("kernel\top\tn\tcycles_per_element\tns_per_element\n");
+	BENCH_CLOCK copy = bench_kernel_sort(NULL, 0, work, src), none = { 0, 0, 0 };
+	for (int k = -1; k < NET_KERNEL_COUNT; k++) {
+		const NET_KERNEL * kernel = (k < 0) ? &BENCH_BASELINE : &NET_KERNELS[k];
+		if (k >= 0 && !net_supported(kernel)) {
+			fprintf(stderr, "Note: the cpu does not support the %s kernel\n", kernel->name);
+			continue;
+		}
+		for (int n = 8; n <= NET_BLOCK_MAX; n <<= 1) {
+			bench_kernel_print(kernel->name, "sort", n, bench_kernel_sort(kernel, n, work, src), copy);
+			for (int b = 0; b + 1 < BENCH_SIMD_ELEMS; b++)
+				if ((b + 1) % n && work[b] > work[b + 1]) {
+					fprintf(stderr, "Error: %s kernel left a %d block unsorted\n", kernel->name, n);
+					failures++;
+					break;
+				}
+		}
+		if (k < 0) continue;
+		bench_kernel_print(kernel->name, "merge", BENCH_SIMD_ELEMS, bench_kernel_merge(kernel, work, runs), none);
+		for (int b = 0; b + 1 < BENCH_SIMD_ELEMS; b++)
+			if (work[b] > work[b + 1]) {
+				fprintf(stderr, "Error: %s kernel merged out of order\n", kernel->name);
+				failures++;
+				break;
+			}
+	}
+
+	mem_free(work);
+	mem_free(runs);
+	mem_free(src);
+	return failures ? 1 : 0;
+}
+
+/*---- HEAP ARITY --------------------------*/
+bool BENCH_HEAP = false;			/* binary heap sort against the d-ary one */
+
+#define	BENCH_SIZES_MAX		16		/* entries accepted by --sizes */
+
+int BENCH_SIZES[BENCH_SIZES_MAX] = { 100000, 1000000, 10000000, 100000000 };
+int BENCH_SIZES_COUNT = 4;			/* --sizes, in the order given */
+bool BENCH_SIZES_SET = false;		/* true when --sizes was given */
+
+/* Parses a comma separated list of sample counts for --sizes, each one
+   like --size. Returns false on the first invalid entry. */
+bool bench_sizes(const char * list) {
+	const char * p = list;
+	BENCH_SIZES_COUNT = 0;
+	BENCH_SIZES_SET = true;
+	while (*p) {
+		char * end;
+		double size = strtod(p, &end);
+		if (end == p || (*end != ',' && *end != '\0') || size != (double)(long long) size ||
+			size < SAMPLE_SIZE_MIN || size > SAMPLE_SIZE_MAX || BENCH_SIZES_COUNT == BENCH_SIZES_MAX)
+			return false;
+		BENCH_SIZES[BENCH_SIZES_COUNT++] = (int) size;
+		p = (*end == ',') ? end + 1 : end;
+	}
+	return BENCH_SIZES_COUNT > 0;
+}
+
+/* Times the binary heap sort and the d-ary one with 2, 4 and 8 children
+   on the same random samples for every --sizes entry. */
+int bench_heap() {
+	const int arities[] = { 2, 4, 8 };
+	int heap = algorithm_find("heap", 4), dheap = algorithm_find("dheap", 5);
+	int arity = HEAP_ARITY, failures = 0;
+
+	ENABLE_VISUALIZATION = false;
+	printf("algorithm\tarity\tn\ttime_ms\tcomparisons\tspeedup\n");
+	for (int z = 0; z < BENCH_SIZES_COUNT; z++) {
+		SAMPLES origin, sort;
+		SAMPLE_SIZE = BENCH_SIZES[z];
+		if (!sample_alloc(&origin) || !sample_alloc(&sort)) {
+			fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+			sample_free(&origin);
+			failures++;
+			continue;
+		}
+		sample_generate_random(&origin);
+
+		double base = 0;
+		for (int r = -1; r < 3; r++) {
+			const ALGORITHM * alg = &ALGORITHMS[r < 0 ? heap : dheap];
+			HEAP_ARITY = r < 0 ? 2 : arities[r];
+			sample_copy(&sort, &origin);
+			double start = mstime();
+			alg->sort(&sort);
+			double elapsed = mstime() - start;
+			if (r < 0) base = elapsed;
+			printf("%s\t%d\t%d\t%.3f\t%ld\t%.2f\n", alg->name, HEAP_ARITY, SAMPLE_SIZE, elapsed,
+				   sort.comparisons, elapsed > 0 ? base / elapsed : 0);
+			fflush(stdout);
+			if (!sample_is_sorted(&sort)) {
+				fprintf(stderr, "Error: %s (arity %d) left samples unsorted\n", alg->name, HEAP_ARITY);
+				failures++;
+			}
+		}
+		sample_free(&sort);
+		sample_free(&origin);
+	}
+
+	HEAP_ARITY = arity;
+	return failures ? 1 : 0;
+}
+
+/*---- RECORD LAYOUTS ---------------------*/
+bool BENCH_RECORDS = false;			/* whole records against (key, index) sorting */
+
+#define	BENCH_RECORDS_SIZE	1000000	/* records when --sizes is not given */
+
+/* Times every record type sorted whole and through (key, index) pairs by
+   both record sorts, for every --sizes entry. After each key width a note
+   names the smallest record the indirect sort is faster on. */
+int bench_records() {
+	int sizes[BENCH_SIZES_MAX] = { BENCH_RECORDS_SIZE }, count = 1, failures = 0;
+	if (BENCH_SIZES_SET) {
+		memcpy(sizes, BENCH_SIZES, sizeof(sizes));
+		count = BENCH_SIZES_COUNT;
+	}
+
+	printf("algorithm\tkey_bits\trecord_bytes\tn\tdirect_ms\tindirect_ms\tspeedup\n");
+	for (int z = 0; z < count; z++) {
+		size_t n = (size_t) sizes[z];
+		void * a = mem_alloc(n * 128, USE_HUGE_PAGES);
+		void * tmp = mem_alloc(n * 128, USE_HUGE_PAGES);
+		void * pairs = mem_alloc(n * sizeof(PAIR64), USE_HUGE_PAGES);
+		if (!a || !tmp || !pairs) {
+			fprintf(stderr, "Error: Cannot allocate %zu records\n", n);
+			mem_free(pairs);
+			mem_free(tmp);
+			mem_free(a);
+			failures++;
+			continue;
+		}
+		/* first touch out of the timings */
+		memset(tmp, 0, n * 128);
+		memset(pairs, 0, n * sizeof(PAIR64));
+
+		for (int alg = 0; alg < RECORD_ALG_COUNT; alg++) {
+			int crossover = 0;
+			for (int r = 0; r < RECORD_TYPE_COUNT; r++) {
+				const RECORD_TYPE * t = &RECORD_TYPES[r];
+				uint64_t base = gen_base();
+				double start, direct, indirect;
+
+				t->fill(a, n, base);
+				start = mstime();
+				t->direct(a, tmp, n, alg);
+				direct = mstime() - start;
+				if (!t->check(a, n, base)) {
+					fprintf(stderr, "Error: direct %s sort broke %d-byte records\n", RECORD_ALGS[alg], t->bytes);
+					failures++;
+				}
+
+				t->fill(a, n, base);
+				start = mstime();
+				t->indirect(a, pairs, tmp, n, alg);
+				indirect = mstime() - start;
+				if (!t->check(a, n, base)) {
+					fprintf(stderr, "Error: indirect %s sort broke %d-byte records\n", RECORD_ALGS[alg], t->bytes);
+					failures++;
+				}
+
+				printf("%s\t%d\t%d\t%zu\t%.3f\t%.3f\t%.2f\n", RECORD_ALGS[alg], t->key_bits, t->bytes, n,
+					   direct, indirect, indirect > 0 ? direct / indirect : 0);
+				fflush(stdout);
+				if (!crossover && indirect < direct) crossover = t->bytes;
+				if (r + 1 == RECORD_TYPE_COUNT || RECORD_TYPES[r + 1].key_bits != t->key_bits) {
+					if (crossover)
+						fprintf(stderr, "Note: indirect %s sort wins from %d-byte records with %d-bit keys\n",
+								RECORD_ALGS[alg], crossover, t->key_bits);
+					else
+						fprintf(stderr, "Note: direct %s sort wins on every record with %d-bit keys\n",
+								RECORD_ALGS[alg], t->key_bits);
+					crossover = 0;
+				}
+			}
+		}
+		mem_free(pairs);
+		mem_free(tmp);
+		mem_free(a);
+	}
+	return failures ? 1 : 0;
+}
+
+/*---- BLOCK PARTITION --------------------*/
+bool BENCH_BLOCK = false;			/* quick sort against block quick sort */
+
+#define	BENCH_BLOCK_SIZE	10000000	/* samples when --sizes is not given */
+
+/* Times quick sort and block quick sort on the same random and few unique
+   samples for every --sizes entry, with the branch misses of each run
+   when the hardware counters can be read. The last columns compare the
+   block partition with the branchy one. */
+int bench_block() {
+	int sizes[BENCH_SIZES_MAX] = { BENCH_BLOCK_SIZE }, count = 1, failures = 0;
+	int algs[2] = { algorithm_find("quick", 5), algorithm_find("block", 5) };
+	struct { const char * name; void (*generate)(SAMPLES *); } layouts[] = {
+		{ "random", sample_generate_random }, { "few", sample_generate_few }
+	};
+	bool perf = PERF_MODE;
+	if (BENCH_SIZES_SET) {
+		memcpy(sizes, BENCH_SIZES, sizeof(sizes));
+		count = BENCH_SIZES_COUNT;
+	}
+
+	ENABLE_VISUALIZATION = false;
+	PERF_MODE = true;
+	printf("algorithm\tdistribution\tn\ttime_ms\tcomparisons\tbranch_misses\tmisses_per_n\tspeedup\tmiss_change\n");
+	for (int z = 0; z < count; z++) {
+		SAMPLES origin, sort;
+		SAMPLE_SIZE = sizes[z];
+		if (!sample_alloc(&origin) || !sample_alloc(&sort)) {
+			fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+			sample_free(&origin);
+			failures++;
+			continue;
+		}
+		for (int d = 0; d < 2; d++) {
+			double base = 0;
+			long misses = -1;
+			layouts[d].generate(&origin);
+			for (int r = 0; r < 2; r++) {
+				const ALGORITHM * alg = &ALGORITHMS[algs[r]];
+				sample_copy(&sort, &origin);
+				perf_start();
+				double start = mstime();
+				alg->sort(&sort);
+				double elapsed = mstime() - start;
+				perf_stop(sort.hw);
+				long bm = sort.hw[HW_BRANCH_MISSES];
+				if (r == 0) base = elapsed, misses = bm;
+
+				printf("%s\t%s\t%d\t%.3f\t%ld", alg->name, layouts[d].name, SAMPLE_SIZE, elapsed, sort.comparisons);
+				if (bm < 0) printf("\t-\t-");
+				else printf("\t%ld\t%.3f", bm, (double) bm / SAMPLE_SIZE);
+				printf("\t%.2f", elapsed > 0 ? base / elapsed : 0);
+				/* branch misses of this run against quick sort, in percent */
+				if (bm < 0 || misses <= 0) printf("\t-\n");
+				else printf("\t%+.1f%%\n", 100.0 * (bm - misses) / misses);
+				fflush(stdout);
+				if (!sample_is_sorted(&sort)) {
+					fprintf(stderr, "Error: %s left %s samples unsorted\n", alg->name, layouts[d].name);
+					failures++;
+				}
+			}
+		}
+		sample_free(&sort);
+		sample_free(&origin);
+	}
+
+	PERF_MODE = perf;
+	return failures ? 1 : 0;
+}
+
+/*---- RADIX KEYS -------------------------*/
+bool BENCH_RADIX = false;			/* radix sort on every key kind */
+
+#define	BENCH_RADIX_SIZE	10000000	/* keys when --sizes is not given */
+
+static const struct {
+	const char *	name;
+	int				bits;
+	int				kind;				/* RADIX_* */
+} RADIX_KEYS[] = {
+	{ "uint32", 32, RADIX_UNSIGNED }, { "int32", 32, RADIX_SIGNED }, { "float", 32, RADIX_FLOAT },
+	{ "uint64", 64, RADIX_UNSIGNED }, { "int64", 64, RADIX_SIGNED }, { "double", 64, RADIX_FLOAT },
+};
+#define	RADIX_KEY_COUNT		(int)(sizeof(RADIX_KEYS) / sizeof(RADIX_KEYS[0]))
+
+static uint64_t radix_key(RNG * r, int bits, int kind) {
+	/* random bits, or for floats finite values of either sign and any
+	   magnitude with one in 64 a zero, infinity or NaN of either sign */
+	uint64_t x = rng_next(r);
+	if (kind != RADIX_FLOAT) return bits == 32 ? x >> 32 : x;
+	unsigned special = (unsigned)(x & 63), sign = (unsigned)(x >> 63);
+	if (bits == 32) {
+		const uint32_t specials[3] = { 0, 0x7F800000u, 0x7FC00000u };	/* zero, infinity, NaN */
+		float f = (float)(ldexp(rng_unit(r), (int) rng_below(r, 120) - 60));
+		uint32_t u;
+		memcpy(&u, &f, sizeof(u));
+		if (special < 3) u = specials[special];
+		return u | (uint32_t) sign << 31;
+	}
+	const uint64_t specials[3] = { 0, 0x7FF0000000000000ULL, 0x7FF8000000000000ULL };
+	double f = ldexp(rng_unit(r), (int) rng_below(r, 1000) - 500);
+	uint64_t u;
+	memcpy(&u, &f, sizeof(u));
+	if (special < 3) u = specials[special];
+	return u | (uint64_t) sign << 63;
+}
+
+static int radix_class(double v, bool negative) {
+	/* negative NaNs first, then the numbers, then positive NaNs */
+	return isnan(v) ? (negative ? 0 : 2) : 1;
+}
+
+static bool radix_in_order(uint64_t x, uint64_t y, int bits, int kind) {
+	/* true if key x may come before key y */
+	if (kind == RADIX_UNSIGNED) return x <= y;
+	if (kind == RADIX_SIGNED) return bits == 32 ? (int32_t) x <= (int32_t) y : (int64_t) x <= (int64_t) y;
+	double a, b;
+	bool na = x >> (bits - 1), nb = y >> (bits - 1);
+	if (bits == 32) {
+		float fa, fb;
+		uint32_t ua = (uint32_t) x, ub = (uint32_t) y;
+		memcpy(&fa, &ua, sizeof(fa));
+		memcpy(&fb, &ub, sizeof(fb));
+		a = fa, b = fb;
+	} else {
+		memcpy(&a, &x, sizeof(a));
+		memcpy(&b, &y, sizeof(b));
+	}
+	int ca = radix_class(a, na), cb = radix_class(b, nb);
+	if (ca != cb || ca != 1) return ca <= cb;
+	if (a == 0 && b == 0) return na || !nb;		/* -0 before 0 */
+	return a <= b;
+}
+
+/* Sorts random keys of every kind with radix_sort32() and radix_sort64()
+   for every --sizes entry and checks the order, including negative zero
+   before zero and NaNs at the ends by their sign bit, and that the keys
+   are the ones it was given. */
+int bench_radix() {
+	int sizes[BENCH_SIZES_MAX] = { BENCH_RADIX_SIZE }, count = 1, failures = 0;
+	if (BENCH_SIZES_SET) {
+		memcpy(sizes, BENCH_SIZES, sizeof(sizes));
+		count = BENCH_SIZES_COUNT;
+	}
+
+	fprintf(stderr, "Note: --seed %llu reproduces these keys\n", gen_seed());
+	printf("key\tn\ttime_ms\tns_per_key\tpasses\n");
+	for (int z = 0; z < count; z++) {
+		size_t n = (size_t) sizes[z];
+		uint64_t * a = (uint64_t *) mem_alloc(n * sizeof(uint64_t), USE_HUGE_PAGES);
+		uint64_t * tmp = (uint64_t *) mem_alloc(n * sizeof(uint64_t), USE_HUGE_PAGES);
+		if (!a || !tmp) {
+			fprintf(stderr, "Error: Cannot allocate %zu keys\n", n);
+			mem_free(tmp);
+			mem_free(a);
+			failures++;
+			continue;
+		}
+		memset(tmp, 0, n * sizeof(uint64_t));		/* first touch out of the timings */
+
+		for (int k = 0; k < RADIX_KEY_COUNT; k++) {
+			int bits = RADIX_KEYS[k].bits, kind = RADIX_KEYS[k].kind, passes;
+			uint32_t * a32 = (uint32_t *) a;
+			uint64_t sum = 0, check = 0;
+			RNG r;
+			rng_seed(&r, gen_base(), 0);
+			for (size_t i = 0; i < n; i++) {
+				uint64_t x = radix_key(&r, bits, kind);
+				if (bits == 32) a32[i] = (uint32_t) x; else a[i] = x;
+				sum += x * 0x9E3779B97F4A7C15ULL;
+			}
+
+			double start = mstime();
+			if (bits == 32) passes = radix_sort32(a32, (unsigned *) tmp, n, kind);
+			else passes = radix_sort64((unsigned long long *) a, (unsigned long long *) tmp, n, kind);
+			double elapsed = mstime() - start;
+
+			bool sorted = true;
+			for (size_t i = 0; i < n; i++) {
+				uint64_t x = (bits == 32) ? a32[i] : a[i];
+				check += x * 0x9E3779B97F4A7C15ULL;
+				if (i && sorted) sorted = radix_in_order((bits == 32) ? a32[i - 1] : a[i - 1], x, bits, kind);
+			}
+			if (!sorted || check != sum) {
+				fprintf(stderr, "Error: radix sort %s %s keys\n", sorted ? "changed" : "misordered", RADIX_KEYS[k].name);
+				failures++;
+			}
+			printf("%s\t%zu\t%.3f\t%.2f\t%d\n", RADIX_KEYS[k].name, n, elapsed, elapsed * 1e6 / (double) n, passes);
+			fflush(stdout);
+		}
+		mem_free(tmp);
+		mem_free(a);
+	}
+	return failures ? 1 : 0;
+}
+
+/*---- COMPLEXITY SWEEP -------------------*/
+/* Times every --algs entry on every --dist layout (random, ascending and
+   few unique by default) for sizes growing geometrically, two per
+   doubling, from 2^lo to 2^hi samples. Each point is the median of at
+   least BENCH_SWEEP_RUNS runs on fresh copies, repeated until
+   BENCH_SWEEP_MS went by, so small sizes are not lost in the clock. An
+   algorithm leaves a layout once a run takes longer than
+   BENCH_SWEEP_LIMIT_MS.
+
+   The time, comparisons and swaps of each algorithm and layout are then
+   fitted with a + c * f(n) for f = n, n log2 n and n^2, least squares on
+   the relative error, next to the slope of log y over log n on the larger
+   half of the sizes. The fitted times give the crossovers: the sizes
+   where one algorithm overtakes another within the range both were
+   measured on. Quick and merge sort run without the network base case
+   unless --simd names a kernel, so their own small range sorts show.
+   Insertion sort loses to quick sort below the smallest size already,
+   so a last table sweeps quick sort's insertion cutoff instead. */
+#define	BENCH_SWEEP_STEPS		2			/* sizes per doubling */
+#define	BENCH_SWEEP_POINTS		(BENCH_SWEEP_STEPS * 29 + 1)
+#define	BENCH_SWEEP_RUNS		3
+#define	BENCH_SWEEP_MS			10.0
+#define	BENCH_SWEEP_LIMIT_MS	1000.0
+#define	BENCH_SWEEP_MARGIN		1.25			/* error ratio two models are not told apart within */
+#define	BENCH_SWEEP_SCAN		16			/* crossover search steps per doubling */
+#define	BENCH_SWEEP_CUTOFF_LOG	16			/* cutoffs are timed on up to 2^16 samples */
+
+const int SWEEP_CUTOFFS[] = { 4, 8, 12, 16, 24, 32, 48, 64 };
+#define	SWEEP_CUTOFF_COUNT		(int)(sizeof(SWEEP_CUTOFFS) / sizeof(SWEEP_CUTOFFS[0]))
+
+enum { SWEEP_TIME, SWEEP_COMPARISONS, SWEEP_SWAPS, SWEEP_METRICS };
+const char * SWEEP_METRIC_NAMES[SWEEP_METRICS] = { "time_ms", "comparisons", "swaps" };
+
+enum { MODEL_N, MODEL_N_LOG_N, MODEL_N2, MODEL_COUNT };
+const char * MODEL_NAMES[MODEL_COUNT] = { "n", "n_log_n", "n^2" };
+
+bool BENCH_SWEEP = false;			/* --bench-sweep */
+int BENCH_SWEEP_LO = 5;				/* --sweep: sizes from 2^lo */
+int BENCH_SWEEP_HI = 22;			/* up to 2^hi */
+
+typedef struct sweep_fit {
+	int			model;				/* lowest error, -1 when there is no fit */
+	bool		ambiguous;			/* another model came within BENCH_SWEEP_MARGIN */
+	double		a, c;				/* a + c * f(n) */
+	double		slope;				/* log-log, NAN below two points */
+	double		error[MODEL_COUNT];	/* rms relative error of each model, -1 for none */
+} SWEEP_FIT;
+
+typedef struct sweep_series {
+	int			count;				/* points measured */
+	bool		stopped;			/* a run went over BENCH_SWEEP_LIMIT_MS */
+	double		n[BENCH_SWEEP_POINTS];
+	double		y[SWEEP_METRICS][BENCH_SWEEP_POINTS];
+	SWEEP_FIT	fit[SWEEP_METRICS];
+} SWEEP_SERIES;
+
+/* Parses "5-22" for --sweep: the powers of two the sizes run between */
+bool bench_sweep_range(const char * range) {
+	int lo, hi;
+	char tail;
+	if (sscanf(range, "%d-%d%c", &lo, &hi, &tail) != 2) return false;
+	/* 2^5 is the first power of two holding SAMPLE_SIZE_MIN samples */
+	if (lo < 5 || hi < lo + 1 || hi > 29) return false;
+	BENCH_SWEEP_LO = lo;
+	BENCH_SWEEP_HI = hi;
+	return true;
+}
+
+static double sweep_model(int model, double n) {
+	switch (model) {
+	case MODEL_N:		return n;
+	case MODEL_N_LOG_N:	return n * log2(n);
+	default:			return n * n;
+	}
+}
+
+static double sweep_eval(const SWEEP_FIT * f, double n) {
+	return f->a + f->c * sweep_model(f->model, n);
+}
+
+static bool sweep_solve(double m[2][3], int k, double x[2]) {
+	/* Gaussian elimination with partial pivoting on k equations */
+	for (int i = 0; i < k; i++) {
+		int p = i;
+		for (int r = i + 1; r < k; r++) if (fabs(m[r][i]) > fabs(m[p][i])) p = r;
+		if (fabs(m[p][i]) < 1e-12) return false;
+		for (int c = 0; c <= k; c++) { double t = m[i][c]; m[i][c] = m[p][c]; m[p][c] = t; }
+		for (int r = i + 1; r < k; r++) {
+			double q = m[r][i] / m[i][i];
+			for (int c = i; c <= k; c++) m[r][c] -= q * m[i][c];
+		}
+	}
+	for (int i = k - 1; i >= 0; i--) {
+		x[i] = m[i][k];
+		for (int c = i + 1; c < k; c++) x[i] -= m[i][c] * x[c];
+		x[i] /= m[i][i];
+	}
+	return true;
+}
+
+/* Fits y = a + c * f(n) for every model, least squares on the relative
+   error, and picks the one with the smallest rms relative error. All
+   models have the same two parameters, so an information criterion would
+   rank them the same way. The fit is ambiguous when another model's error
+   is within BENCH_SWEEP_MARGIN of the best. Points with y = 0 are left
+   out. */
+static SWEEP_FIT sweep_fit(const double * n, const double * y, int count) {
+	SWEEP_FIT best = { -1, false, 0, 0, NAN, { -1, -1, -1 } };
+	double fitted[MODEL_COUNT][2];
+	for (int m = 0; m < MODEL_COUNT; m++) {
+		int used = 0;
+		double scale[2] = { 0 }, eq[2][3] = { { 0 } }, x[2], err = 0;
+		for (int i = 0; i < count; i++) {
+			/* 1 and f(n), each scaled to at most 1 so the equations stay
+			   well conditioned */
+			double t[2] = { 1, sweep_model(m, n[i]) };
+			if (y[i] > 0) for (int j = 0; j < 2; j++) scale[j] = fmax(scale[j], t[j] / y[i]);
+		}
+		for (int i = 0; i < count; i++) {
+			if (y[i] <= 0) continue;
+			double t[2] = { 1, sweep_model(m, n[i]) }, row[2];
+			for (int j = 0; j < 2; j++) row[j] = t[j] / y[i] / scale[j];
+			for (int r = 0; r < 2; r++) {
+				for (int c = 0; c < 2; c++) eq[r][c] += row[r] * row[c];
+				eq[r][2] += row[r];
+			}
+			used++;
+		}
+		if (used <= 2 || !sweep_solve(eq, 2, x)) continue;
+		SWEEP_FIT f = { m, false, x[0] / scale[0], x[1] / scale[1], NAN, { 0 } };
+		if (f.c <= 0) continue;			/* does not grow like f(n) */
+		for (int i = 0; i < count; i++)
+			if (y[i] > 0) {
+				double r = (sweep_eval(&f, n[i]) - y[i]) / y[i];
+				err += r * r;
+			}
+		best.error[m] = sqrt(err / used);
+		fitted[m][0] = f.a;
+		fitted[m][1] = f.c;
+		if (best.model < 0 || best.error[m] < best.error[best.model]) best.model = m;
+	}
+	if (best.model >= 0) {
+		best.a = fitted[best.model][0];
+		best.c = fitted[best.model][1];
+		for (int m = 0; m < MODEL_COUNT; m++)
+			if (m != best.model && best.error[m] >= 0 &&
+				best.error[m] <= BENCH_SWEEP_MARGIN * best.error[best.model]) best.ambiguous = true;
+	}
+
+	/* log-log slope on the larger half: 1 for n, a little over for n log n,
+	   2 for n^2 */
+	double sx = 0, sy = 0, sxx = 0, sxy = 0;
+	int used = 0;
+	for (int i = count / 2; i < count; i++) {
+		if (y[i] <= 0) continue;
+		double lx = log(n[i]), ly = log(y[i]);
+		sx += lx; sy += ly; sxx += lx * lx; sxy += lx * ly;
+		used++;
+	}
+	if (used >= 2 && used * sxx - sx * sx > 0) best.slope = (used * sxy - sx * sy) / (used * sxx - sx * sx);
+	return best;
+}
+
+/* Prints the sizes within [lo, hi] where the fitted times of x and y
+   cross, found on a geometric scan and refined by bisection */
+static void sweep_crossovers(const char * dist, int ix, const SWEEP_SERIES * x, int iy, const SWEEP_SERIES * y) {
+	const SWEEP_FIT * fx = &x->fit[SWEEP_TIME], * fy = &y->fit[SWEEP_TIME];
+	if (fx->model < 0 || fy->model < 0 || !x->count || !y->count) return;
+	double lo = fmax(x->n[0], y->n[0]), hi = fmin(x->n[x->count - 1], y->n[y->count - 1]);
+	double step = pow(2, 1.0 / BENCH_SWEEP_SCAN);
+	double at = lo, d = sweep_eval(fx, lo) - sweep_eval(fy, lo);
+	while (at < hi) {
+		double next = fmin(at * step, hi), dn = sweep_eval(fx, next) - sweep_eval(fy, next);
+		if ((d < 0) != (dn < 0) && d != 0) {
+			double a = at, b = next;
+			for (int k = 0; k < 40; k++) {
+				double mid = sqrt(a * b);
+				if ((sweep_eval(fx, mid) - sweep_eval(fy, mid) < 0) == (d < 0)) a = mid;
+				else b = mid;
+			}
+			double n = sqrt(a * b);
+			printf("%s\t%s\t%s\t%.0f\t%.4f\n", dist, ALGORITHMS[d < 0 ? ix : iy].name,
+				   ALGORITHMS[d < 0 ? iy : ix].name, n, sweep_eval(fx, n));
+		}
+		at = next;
+		d = dn;
+	}
+}
+
+/* Times algorithm a on fresh copies of origin: one warmup, then runs
+   until enough time went by. Returns the runs, none when the warmup took
+   longer than BENCH_SWEEP_LIMIT_MS. */
+static int sweep_runs(int a, SAMPLES * sort, const SAMPLES * origin, double * times, double * slowest) {
+	int runs = 0;
+	double spent = 0;
+	*slowest = 0;
+	for (int r = -1; r < BENCH_REPEAT_MAX; r++) {
+		sample_copy(sort, origin);
+		double start = mstime();
+		ALGORITHMS[a].sort(sort);
+		double elapsed = mstime() - start;
+		*slowest = fmax(*slowest, elapsed);
+		if (r < 0) {
+			if (elapsed > BENCH_SWEEP_LIMIT_MS) break;
+			continue;
+		}
+		times[runs++] = elapsed;
+		spent += elapsed;
+		if (runs >= BENCH_SWEEP_RUNS && spent >= BENCH_SWEEP_MS) break;
+	}
+	return runs;
+}
+
+/* Times quick sort (algorithm quick) with every SWEEP_CUTOFFS value as
+   QUICK_INSERTION on each layout and prints the medians, also relative
+   to the default cutoff. Returns the failures. */
+static int sweep_cutoffs(int quick) {
+	SAMPLES origin, sort;
+	double times[BENCH_REPEAT_MAX], median[SWEEP_CUTOFF_COUNT], slowest;
+	int failures = 0, keep = QUICK_INSERTION;
+
+	SAMPLE_SIZE = 1 << (BENCH_SWEEP_HI < BENCH_SWEEP_CUTOFF_LOG ? BENCH_SWEEP_HI : BENCH_SWEEP_CUTOFF_LOG);
+	if (!sample_alloc(&origin) || !sample_alloc(&sort)) {
+		fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+		sample_free(&origin);
+		return 1;
+	}
+	printf("\ndistribution\tcutoff\tn\ttime_ms\tvs_default\n");
+	for (int d = 0; d < DISTRIBUTION_COUNT; d++) {
+		if (!gen_wanted(d)) continue;
+		DISTRIBUTIONS[d].generate(&origin);
+		double base = 0;
+		for (int c = 0; c < SWEEP_CUTOFF_COUNT; c++) {
+			QUICK_INSERTION = SWEEP_CUTOFFS[c];
+			int runs = sweep_runs(quick, &sort, &origin, times, &slowest);
+			if (!sample_is_sorted(&sort)) {
+				fprintf(stderr, "Error: quick sort with cutoff %d left %s samples unsorted\n",
+						QUICK_INSERTION, DISTRIBUTIONS[d].name);
+				failures++;
+			}
+			median[c] = runs ? bench_stats(times, runs).median : slowest;
+			if (QUICK_INSERTION == keep) base = median[c];
+		}
+		for (int c = 0; c < SWEEP_CUTOFF_COUNT; c++) {
+			printf("%s\t%d\t%d\t%.6f", DISTRIBUTIONS[d].name, SWEEP_CUTOFFS[c], SAMPLE_SIZE, median[c]);
+			if (base > 0) printf("\t%.3f\n", median[c] / base);
+			else printf("\t-\n");
+		}
+	}
+	QUICK_INSERTION = keep;
+	sample_free(&sort);
+	sample_free(&origin);
+	return failures;
+}
+
+/* Runs the sweep and prints four tab separated tables, blank line
+   apart: the measured points, the fits, the crossovers and the quick
+   sort cutoffs. */
+int bench_sweep() {
+	SWEEP_SERIES * series = (SWEEP_SERIES *) calloc((size_t)(ALGORITHM_COUNT * DISTRIBUTION_COUNT), sizeof(SWEEP_SERIES));
+	double times[BENCH_REPEAT_MAX];
+	int failures = 0;
+
+	if (!series) die(1, "Error: Out of memory for the sweep\n");
+	if (!GEN_FILTER) gen_select("random,ascending,few");
+	ENABLE_VISUALIZATION = false;
+	if (!SIMD_CHOICE) NET_BASE = false;
+	fprintf(stderr, "Note: --seed %llu reproduces these samples\n", gen_seed());
+
+	printf("algorithm\tdistribution\tn\ttime_ms\truns\tcomparisons\tswaps\n");
+	for (int k = BENCH_SWEEP_STEPS * BENCH_SWEEP_LO; k <= BENCH_SWEEP_STEPS * BENCH_SWEEP_HI; k++) {
+		SAMPLES origin, sort;
+		SAMPLE_SIZE = (int) llround(pow(2, (double) k / BENCH_SWEEP_STEPS));
+		if (!sample_alloc(&origin) || !sample_alloc(&sort)) {
+			fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+			sample_free(&origin);
+			failures++;
+			break;
+		}
+		for (int d = 0; d < DISTRIBUTION_COUNT; d++) {
+			if (!gen_wanted(d)) continue;
+			DISTRIBUTIONS[d].generate(&origin);
+			for (int a = 0; a < ALGORITHM_COUNT; a++) {
+				SWEEP_SERIES * sr = &series[a * DISTRIBUTION_COUNT + d];
+				if ((BENCH_FILTER && !BENCH_PICKED[a]) || sr->stopped) continue;
+
+				double slowest;
+				int runs = sweep_runs(a, &sort, &origin, times, &slowest);
+				if (!sample_is_sorted(&sort)) {
+					fprintf(stderr, "Error: %s left %d %s samples unsorted\n", ALGORITHMS[a].name, SAMPLE_SIZE,
+							DISTRIBUTIONS[d].name);
+					failures++;
+				}
+				if (slowest > BENCH_SWEEP_LIMIT_MS) {
+					fprintf(stderr, "Note: %s on %s samples stops at %d, a run took %.0f ms\n",
+							ALGORITHMS[a].name, DISTRIBUTIONS[d].name, SAMPLE_SIZE, slowest);
+					sr->stopped = true;
+				}
+				if (!runs) continue;
+
+				int i = sr->count++;
+				sr->n[i] = SAMPLE_SIZE;
+				sr->y[SWEEP_TIME][i] = bench_stats(times, runs).median;
+				sr->y[SWEEP_COMPARISONS][i] = (double) sort.comparisons;
+				sr->y[SWEEP_SWAPS][i] = (double) sort.swaps;
+				printf("%s\t%s\t%d\t%.6f\t%d\t%ld\t%ld\n", ALGORITHMS[a].name, DISTRIBUTIONS[d].name, SAMPLE_SIZE,
+					   sr->y[SWEEP_TIME][i], runs, sort.comparisons, sort.swaps);
+				fflush(stdout);
+			}
+		}
+		sample_free(&sort);
+		sample_free(&origin);
+	}
+
+	/* an ambiguous model prints as such, c and a are then those of the
+	   lowest error column */
+	printf("\nalgorithm\tdistribution\tmetric\tmodel\tc\ta\tslope\terr_n\terr_n_log_n\terr_n^2\tpoints\n");
+	for (int d = 0; d < DISTRIBUTION_COUNT; d++)
+		for (int a = 0; a < ALGORITHM_COUNT; a++) {
+			SWEEP_SERIES * sr = &series[a * DISTRIBUTION_COUNT + d];
+			if (!sr->count) continue;
+			for (int m = 0; m < SWEEP_METRICS; m++) {
+				SWEEP_FIT * f = &sr->fit[m];
+				*f = sweep_fit(sr->n, sr->y[m], sr->count);
+				printf("%s\t%s\t%s", ALGORITHMS[a].name, DISTRIBUTIONS[d].name, SWEEP_METRIC_NAMES[m]);
+				if (f->model < 0) printf("\t-\t-\t-");
+				else printf("\t%s\t%.6g\t%.6g", f->ambiguous ? "ambiguous" : MODEL_NAMES[f->model], f->c, f->a);
+				if (isnan(f->slope)) printf("\t-");
+				else printf("\t%.3f", f->slope);
+				for (int e = 0; e < MODEL_COUNT; e++) {
+					if (f->error[e] < 0) printf("\t-");
+					else printf("\t%.4f", f->error[e]);
+				}
+				printf("\t%d\n", sr->count);
+			}
+		}
+
+	/* the faster algorithm below and above each crossover, with the
+	   fitted time both take there */
+	printf("\ndistribution\tfaster_below\tfaster_above\tn\ttime_ms\n");
+	for (int d = 0; d < DISTRIBUTION_COUNT; d++)
+		for (int a = 0; a < ALGORITHM_COUNT; a++)
+			for (int b = a + 1; b < ALGORITHM_COUNT; b++)
+				sweep_crossovers(DISTRIBUTIONS[d].name, a, &series[a * DISTRIBUTION_COUNT + d],
+								 b, &series[b * DISTRIBUTION_COUNT + d]);
+
+	for (int a = 0; a < ALGORITHM_COUNT; a++)
+		if (strcmp(ALGORITHMS[a].name, "quick") == 0 && (!BENCH_FILTER || BENCH_PICKED[a]))
+			failures += sweep_cutoffs(a);
+	free(series);
+	return failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,162 @@
+#ifndef __SORTVIS_CACHE__
+#define __SORTVIS_CACHE__
+
+/*---- CACHE MODEL -------------------------*/
+/* A deterministic model of up to three cache levels, each set associative
+   with LRU replacement, fed with the samples every event touches (see
+   event_accesses()). An access looks up each level in turn until one
+   hits and is filled into every level that missed, so the levels are
+   neither inclusive nor exclusive, like most real ones. The model sees
+   the samples starting on a line boundary and scratch memory on the
+   lines after them, not bulk copies, so it predicts how a sort walks its
+   data rather than the exact counts of a given cpu. */
+#define	CACHE_LEVEL_MAX		3
+#define	CACHE_WAYS_MAX		64
+#define	CACHE_MEMORY		(CACHE_LEVEL_MAX + 1)	/* served by memory, see cache_served() */
+
+typedef struct cache_level {
+	long		size;				/* bytes */
+	int			ways;
+} CACHE_LEVEL;
+
+bool CACHE_MODE = false;			/* --cache: model the accesses of the sorts */
+int CACHE_LINE_BYTES = 64;			/* --cache-line */
+int CACHE_LEVEL_COUNT = 3;			/* --cache-levels */
+CACHE_LEVEL CACHE_LEVELS[CACHE_LEVEL_MAX] = {
+	{ 32 << 10, 8 }, { 1 << 20, 16 }, { 32 << 20, 16 }
+};
+
+const char * CACHE_NAMES[CACHE_COUNTERS] = {
+	"sim_l1_hits", "sim_l1_misses", "sim_l2_hits", "sim_l2_misses", "sim_l3_hits", "sim_l3_misses"
+};
+
+static uint64_t *		cacheTags[CACHE_LEVEL_MAX];	/* sets * ways lines + 1, most recent first, 0 for empty */
+static long				cacheSets[CACHE_LEVEL_MAX];
+static unsigned char *	cacheServed;				/* per sample: level of the last access shown there, 0 for none */
+static int				cacheSize;					/* samples cacheServed holds */
+
+/* Parses "32K/8,1M/16,32M/16", a size with an optional K, M or G and
+   the ways of each level, L1 first. Returns false on a malformed list,
+   cache_valid() checks the sets once the line size is known too. */
+bool cache_levels(const char * list) {
+	const char * p = list;
+	int count = 0;
+	while (*p) {
+		char * end;
+		double size = strtod(p, &end);
+		if (*end == 'K' || *end == 'k') size *= 1 << 10, end++;
+		else if (*end == 'M' || *end == 'm') size *= 1 << 20, end++;
+		else if (*end == 'G' || *end == 'g') size *= 1 << 30, end++;
+		if (end == p || *end != '/' || count == CACHE_LEVEL_MAX || size < 1 || size > (double)(1L << 40))
+			return false;
+		p = end + 1;
+		long ways = strtol(p, &end, 10);
+		if (end == p || (*end != ',' && *end != '\0') || ways < 1 || ways > CACHE_WAYS_MAX) return false;
+		CACHE_LEVELS[count].size = (long) size;
+		CACHE_LEVELS[count++].ways = (int) ways;
+		p = (*end == ',') ? end + 1 : end;
+	}
+	CACHE_LEVEL_COUNT = count;
+	return count > 0;
+}
+
+bool cache_valid() {
+	/* the line is a power of two and every level a whole number of sets */
+	if (CACHE_LINE_BYTES < (int) sizeof(int) || (CACHE_LINE_BYTES & (CACHE_LINE_BYTES - 1))) return false;
+	for (int l = 0; l < CACHE_LEVEL_COUNT; l++) {
+		long set = (long) CACHE_LINE_BYTES * CACHE_LEVELS[l].ways;
+		if (CACHE_LEVELS[l].size % set) return false;
+	}
+	return true;
+}
+
+/* Empties every level and forgets where the samples were served from,
+   before a run is fed in */
+void cache_reset() {
+	if (!CACHE_MODE) return;
+	for (int l = 0; l < CACHE_LEVEL_COUNT; l++) {
+		long sets = CACHE_LEVELS[l].size / ((long) CACHE_LINE_BYTES * CACHE_LEVELS[l].ways);
+		size_t bytes = (size_t) sets * CACHE_LEVELS[l].ways * sizeof(uint64_t);
+		if (!cacheTags[l] || cacheSets[l] != sets) {
+			mem_free(cacheTags[l]);
+			cacheTags[l] = (uint64_t *) mem_alloc(bytes, false);
+			cacheSets[l] = sets;
+		}
+		if (!cacheTags[l]) die(1, "Error: Out of memory for the cache model\n");
+		memset(cacheTags[l], 0, bytes);
+	}
+	if (!cacheServed || cacheSize != SAMPLE_SIZE) {
+		mem_free(cacheServed);
+		cacheServed = (unsigned char *) mem_alloc((size_t) SAMPLE_SIZE, USE_HUGE_PAGES);
+		cacheSize = SAMPLE_SIZE;
+	}
+	if (!cacheServed) die(1, "Error: Out of memory for the cache model\n");
+	memset(cacheServed, 0, (size_t) SAMPLE_SIZE);
+}
+
+static bool cache_lookup(int l, uint64_t line) {
+	/* true on a hit; either way line ends up the most recent of its set */
+	int ways = CACHE_LEVELS[l].ways, w = 0;
+	uint64_t * set = cacheTags[l] + (size_t)((line - 1) % (uint64_t) cacheSets[l]) * ways;
+	while (w < ways - 1 && set[w] != line) w++;
+	bool hit = set[w] == line;
+	memmove(set + 1, set, (size_t) w * sizeof(uint64_t));
+	set[0] = line;
+	return hit;
+}
+
+/* One access to address at, see access_address(), shown at sample index;
+   counts hits and misses into s->cache */
+void cache_access(SAMPLES * s, int at, int index) {
+	if (at < 0 || at >= access_limit()) return;	/* a value held aside */
+	uint64_t line = (uint64_t) at * sizeof(int) / (uint64_t) CACHE_LINE_BYTES + 1;
+	int l = 0;
+	for (; l < CACHE_LEVEL_COUNT; l++) {
+		if (cache_lookup(l, line)) {
+			s->cache[2 * l]++;
+			break;
+		}
+		s->cache[2 * l + 1]++;
+	}
+	/* relaxed: the live renderer reads it while the worker sorts */
+	if (index >= 0 && index < cacheSize)
+		__atomic_store_n(&cacheServed[index], (unsigned char)(l < CACHE_LEVEL_COUNT ? l + 1 : CACHE_MEMORY),
+						 __ATOMIC_RELAXED);
+}
+
+void cache_event(SAMPLES * s, const EVENT * e) {
+	MEM_ACCESS m[4];
+	if (!CACHE_MODE) return;
+	for (int n = event_accesses(e, m), j = 0; j < n; j++)
+		cache_access(s, m[j].at, m[j].index);
+}
+
+int cache_served(int i) {
+	/* 1 to CACHE_LEVEL_MAX for the level that served the last access to
+	   sample i, CACHE_MEMORY for memory, 0 before any */
+	if (!CACHE_MODE || !cacheServed || i < 0 || i >= cacheSize) return 0;
+	return __atomic_load_n(&cacheServed[i], __ATOMIC_RELAXED);
+}
+
+/* EVENTS.flush of the modelled run */
+void cache_flush(EVENTS * ev) {
+	SAMPLES * s = (SAMPLES *) ev->sink;
+	for (size_t k = 0; k < ev->count; k++)
+		cache_event(s, &ev->list[k]);
+	ev->count = 0;
+}
+
+/* Sorts s with the model fed from its events, the counts end in s->cache */
+void cache_run(const ALGORITHM * alg, SAMPLES * s) {
+	EVENTS ev = { (EVENT *) malloc(LOC_BLOCK * sizeof(EVENT)), 0, LOC_BLOCK, cache_flush, s };
+	if (!ev.list) die(1, "Error: Out of memory for the cache model\n");
+	memset(s->cache, 0, sizeof(s->cache));
+	cache_reset();
+	sample_events = &ev;
+	alg->sort(s);
+	sample_events = NULL;
+	cache_flush(&ev);
+	free(ev.list);
+}
+
+#endif
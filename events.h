@@ -0,0 +1,90 @@
+#ifndef __SORTVIS_EVENTS__
+#define __SORTVIS_EVENTS__
+
+#include <pthread.h>
+
+/*---- SORT OPERATION EVENTS ---------------*/
+/* Algorithms never draw. They report what they do as a stream of events
+   and whoever listens (the animation, a trace file, statistics) consumes
+   the recording afterwards. With no recorder attached emitting is a single
+   test, so headless runs go at native speed. Sorts working in scratch
+   memory report compares and writes there under the index the animation
+   shows them at, flagged EV_IN_SCRATCH, and the loads and stores nothing
+   else shows as EV_ACCESS, so the locality and cache models see every
+   buffer. Bulk copies only report their size. */
+
+enum {
+	EV_COMPARE,		/* a, b: indices compared (-1 for a value held aside), c: flags */
+	EV_SWAP,		/* a, b: indices exchanged */
+	EV_WRITE,		/* a: index, b: value stored, c: flags */
+	EV_MOVE,		/* a: index copied to scratch memory, b: its slot there */
+	EV_SORTED,		/* a: last index of the sorted region */
+	EV_PIVOT,		/* a: index of the pivot, -1 for none */
+	EV_BOUNDS,		/* a, b: region being worked on, -1 for none */
+	EV_STEP,		/* a, b, c: highlighted indices, frame with a full delay */
+	EV_FLASH,		/* a, b, c: highlighted indices, frame with a short delay */
+	EV_FRAME,		/* a, b, c: highlighted indices, frame without delay */
+	EV_REGION,		/* a, b: range worked on by thread c, -1 for none */
+	EV_STEAL,		/* a: thread that stole a task */
+	EV_DEPTH,		/* a: recursion depth reached */
+	EV_AUX,			/* a: samples of scratch memory in use */
+	EV_COPY,		/* a: samples copied between buffers */
+	EV_ACCESS,		/* a: index or slot loaded, c: flags */
+	EV_COUNT
+};
+
+/* flags of EV_COMPARE, EV_WRITE and EV_ACCESS */
+#define	EV_COUNTED		1		/* the write counts as a swap */
+#define	EV_IN_SCRATCH	2		/* the access went to the slot of scratch memory a (and b) name */
+#define	EV_STORE		4		/* the access is a store */
+
+typedef struct event {
+	int		op;				/* EV_* */
+	int		a, b, c;		/* operands, see above */
+} EVENT;
+
+typedef struct events {
+	EVENT *	list;
+	size_t	count;
+	size_t	cap;
+	void	(*flush)(struct events *);	/* drains a full list, NULL to grow it instead */
+	void *	sink;						/* flush() state */
+} EVENTS;
+
+EVENTS * sample_events = NULL;		/* recorder the algorithms emit into */
+bool events_shared = false;			/* several threads may emit at once */
+/* taken when shared; a mutex rather than a spin lock since a flush may
+   sleep for the animation while the other threads wait */
+static pthread_mutex_t events_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void events_free(EVENTS * ev) {
+	free(ev->list);
+	ev->list = NULL;
+	ev->count = ev->cap = 0;
+}
+
+void events_grow(EVENTS * ev) {
+	size_t cap = ev->cap ? ev->cap << 1 : 4096;
+	EVENT * list = (EVENT *) realloc(ev->list, cap * sizeof(EVENT));
+	if (!list) die(1, "Error: Out of memory for event recording\n");
+	ev->list = list;
+	ev->cap = cap;
+}
+
+void event_emit(int op, int a, int b, int c) {
+	EVENTS * ev = sample_events;
+	if (!ev) return;
+	if (events_shared) pthread_mutex_lock(&events_lock);
+	if (ev->count == ev->cap) {
+		if (ev->flush && ev->cap) ev->flush(ev);
+		else events_grow(ev);
+	}
+	EVENT * e = &ev->list[ev->count++];
+	e->op = op;
+	e->a = a;
+	e->b = b;
+	e->c = c;
+	if (events_shared) pthread_mutex_unlock(&events_lock);
+}
+
+#endif
@@ -0,0 +1,423 @@
+#ifndef __SORTVIS_GEN__
+#define __SORTVIS_GEN__
+
+#include <stdint.h>
+#include <math.h>
+
+/*---- RANDOM NUMBERS ----------------------*/
+/* xoshiro256** seeded through splitmix64. Every generation draws a base
+   from the --seed stream and every slice of the samples gets its own
+   stream from it, so the same seed gives the same samples whatever the
+   number of threads. */
+typedef struct rng {
+	uint64_t	s[4];
+} RNG;
+
+unsigned long long GEN_SEED = 0;	/* --seed, or the clock when not given */
+bool GEN_SEEDED = false;			/* true once GEN_SEED holds the seed */
+static RNG genRng;					/* draws the base of every generation */
+static bool genStarted = false;
+
+static uint64_t rng_mix(uint64_t * x) {
+	/* splitmix64 */
+	uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+void rng_seed(RNG * r, uint64_t seed, uint64_t stream) {
+	uint64_t x = seed ^ (stream * 0xD1B54A32D192ED03ULL);
+	for (int i = 0; i < 4; i++) r->s[i] = rng_mix(&x);
+}
+
+static inline uint64_t rng_rotl(uint64_t x, int k) {
+	return (x << k) | (x >> (64 - k));
+}
+
+static inline uint64_t rng_next(RNG * r) {
+	uint64_t * s = r->s, out = rng_rotl(s[1] * 5, 7) * 9, t = s[1] << 17;
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rng_rotl(s[3], 45);
+	return out;
+}
+
+static inline uint32_t rng_below(RNG * r, uint32_t n) {
+	/* unbiased 0..n-1, Lemire's multiply and reject */
+	uint64_t m = (rng_next(r) >> 32) * n;
+	if ((uint32_t) m < n) {
+		uint32_t floor = -n % n;
+		while ((uint32_t) m < floor) m = (rng_next(r) >> 32) * n;
+	}
+	return (uint32_t)(m >> 32);
+}
+
+static inline double rng_unit(RNG * r) {
+	/* uniform in [0, 1) */
+	return (double)(rng_next(r) >> 11) * 0x1.0p-53;
+}
+
+unsigned long long gen_seed() {
+	if (!GEN_SEEDED) {
+		GEN_SEED = (unsigned long long) time(NULL) ^ ((unsigned long long) clock() << 32);
+		GEN_SEEDED = true;
+	}
+	return GEN_SEED;
+}
+
+static uint64_t gen_base() {
+	/* seed of the next generation */
+	if (!genStarted) {
+		rng_seed(&genRng, gen_seed(), 0);
+		genStarted = true;
+	}
+	return rng_next(&genRng);
+}
+
+/*---- SAMPLE GENERATORS -------------------*/
+/* Every layout holds values 1..SAMPLE_SIZE. The samples are cut into
+   GEN_SLICES fixed slices that fill in parallel from a million samples
+   up. Random samples are a Rao-Sandelius shuffle: each value goes to a
+   random bucket small enough for the cache, then every bucket gets a
+   Fisher-Yates shuffle, which is a uniform permutation overall. */
+#define	GEN_SLICES		64			/* slices filled independently */
+#define	GEN_PARALLEL	(1 << 20)	/* fewest samples generated on the pool */
+#define	GEN_BUCKET		(1 << 15)	/* samples per shuffle bucket */
+#define	GEN_FEW			16			/* values of few-unique samples */
+#define	GEN_TEETH		8			/* ramps of sawtooth samples */
+#define	GEN_ZIPF		1.0			/* exponent of zipf samples */
+
+int GEN_PERTURB = 5;				/* --perturb: percent of nearly sorted samples moved */
+
+typedef struct gen_job {
+	SAMPLES *	s;
+	int			lo, hi;				/* slice, or buckets lo..hi-1 when shuffling */
+	int			slice;
+	uint64_t	base;
+	int *		count;				/* shuffle: slices x buckets counters */
+	int			buckets;
+} GEN_JOB;
+
+static void gen_run(SAMPLES * s, void (*fill)(void *), int n, uint64_t base, int * count, int buckets) {
+	/* runs fill over n slices of 0..n-1, on the pool for large samples */
+	GEN_JOB jobs[GEN_SLICES];
+	TASK_GROUP g = { 0 };
+	for (int t = 0; t < GEN_SLICES; t++) {
+		GEN_JOB j = { s, (int)((long long) n * t / GEN_SLICES), (int)((long long) n * (t + 1) / GEN_SLICES),
+					  t, base, count, buckets };
+		jobs[t] = j;
+	}
+	if (SAMPLE_SIZE < GEN_PARALLEL || pool_size() == 1) {
+		for (int t = 0; t < GEN_SLICES; t++) fill(&jobs[t]);
+		return;
+	}
+	for (int t = 1; t < GEN_SLICES; t++) pool_spawn(&g, fill, &jobs[t]);
+	fill(&jobs[0]);
+	pool_wait(&g);
+}
+
+static void gen_done(SAMPLES * s) {
+	s->max = SAMPLE_SIZE;
+	sample_reset(s);
+}
+
+static void gen_ascending(void * arg) {
+	GEN_JOB * j = (GEN_JOB *) arg;
+	for (int i = j->lo; i < j->hi; i++) j->s->data[i] = i + 1;
+}
+
+static void gen_descending(void * arg) {
+	GEN_JOB * j = (GEN_JOB *) arg;
+	for (int i = j->lo; i < j->hi; i++) j->s->data[i] = SAMPLE_SIZE - i;
+}
+
+static void gen_few(void * arg) {
+	GEN_JOB * j = (GEN_JOB *) arg;
+	int step = SAMPLE_SIZE / GEN_FEW;
+	RNG r;
+	rng_seed(&r, j->base, j->slice);
+	for (int i = j->lo; i < j->hi; i++) j->s->data[i] = (int)(rng_below(&r, GEN_FEW) + 1) * step;
+}
+
+static void gen_sawtooth(void * arg) {
+	GEN_JOB * j = (GEN_JOB *) arg;
+	int len = (SAMPLE_SIZE + GEN_TEETH - 1) / GEN_TEETH, r = j->lo % len;
+	double scale = (double) SAMPLE_SIZE / len;
+	for (int i = j->lo; i < j->hi; i++, r = (r + 1 == len) ? 0 : r + 1)
+		j->s->data[i] = (int)(r * scale) + 1;
+}
+
+static void gen_organ(void * arg) {
+	GEN_JOB * j = (GEN_JOB *) arg;
+	for (int i = j->lo; i < j->hi; i++)
+		j->s->data[i] = (i < (SAMPLE_SIZE + 1) / 2) ? 2 * i + 1 : 2 * (SAMPLE_SIZE - i);
+}
+
+static void gen_equal(void * arg) {
+	GEN_JOB * j = (GEN_JOB *) arg;
+	for (int i = j->lo; i < j->hi; i++) j->s->data[i] = (SAMPLE_SIZE + 1) / 2;
+}
+
+/* Zipf ranks 1..SAMPLE_SIZE by rejection-inversion (Hoermann and
+   Derflinger), constant time per sample whatever the number of ranks */
+static double zipf_h(double x) {
+	/* integral of x^-GEN_ZIPF */
+	double l = log(x), t = (1 - GEN_ZIPF) * l;
+	return (fabs(t) > 1e-8 ? expm1(t) / t : 1 + t / 2) * l;
+}
+
+static double zipf_h_inv(double y) {
+	double t = (1 - GEN_ZIPF) * y;
+	return exp((fabs(t) > 1e-8 ? log1p(t) / t : 1 - t / 2) * y);
+}
+
+static void gen_zipf(void * arg) {
+	GEN_JOB * j = (GEN_JOB *) arg;
+	double hx1 = zipf_h(1.5) - 1, hn = zipf_h(SAMPLE_SIZE + 0.5);
+	double squeeze = 2 - zipf_h_inv(zipf_h(2.5) - exp(-GEN_ZIPF * log(2.0)));
+	RNG r;
+	rng_seed(&r, j->base, j->slice);
+	for (int i = j->lo; i < j->hi; i++) {
+		for (;;) {
+			double u = hn + rng_unit(&r) * (hx1 - hn), x = zipf_h_inv(u);
+			int k = (int)(x + 0.5);
+			if (k < 1) k = 1;
+			else if (k > SAMPLE_SIZE) k = SAMPLE_SIZE;
+			if (k - x <= squeeze || u >= zipf_h(k + 0.5) - exp(-GEN_ZIPF * log((double) k))) {
+				j->s->data[i] = k;
+				break;
+			}
+		}
+	}
+}
+
+static void shuffle_count(void * arg) {
+	/* bucket of every value of the slice */
+	GEN_JOB * j = (GEN_JOB *) arg;
+	int * count = j->count + (size_t) j->slice * j->buckets;
+	RNG r;
+	rng_seed(&r, j->base, j->slice);
+	for (int i = j->lo; i < j->hi; i++) count[rng_below(&r, j->buckets)]++;
+}
+
+static void shuffle_scatter(void * arg) {
+	/* same draws again, the counters now hold positions */
+	GEN_JOB * j = (GEN_JOB *) arg;
+	int * count = j->count + (size_t) j->slice * j->buckets, * data = j->s->data;
+	RNG r;
+	rng_seed(&r, j->base, j->slice);
+	for (int i = j->lo; i < j->hi; i++) data[count[rng_below(&r, j->buckets)]++] = i + 1;
+}
+
+static void shuffle_range(int * a, int n, RNG * r) {
+	/* Fisher-Yates */
+	for (int i = n - 1; i > 0; i--) {
+		int k = (int) rng_below(r, (uint32_t) i + 1), t = a[i];
+		a[i] = a[k];
+		a[k] = t;
+	}
+}
+
+static void shuffle_buckets(void * arg) {
+	/* count holds the first position of every bucket, then the end */
+	GEN_JOB * j = (GEN_JOB *) arg;
+	for (int b = j->lo; b < j->hi; b++) {
+		RNG r;
+		rng_seed(&r, j->base, GEN_SLICES + b);
+		shuffle_range(j->s->data + j->count[b], j->count[b + 1] - j->count[b], &r);
+	}
+}
+
+void sample_generate_ascending(SAMPLES * s) {
+	gen_run(s, gen_ascending, SAMPLE_SIZE, 0, NULL, 0);
+	gen_done(s);
+}
+
+void sample_generate_descending(SAMPLES * s) {
+	gen_run(s, gen_descending, SAMPLE_SIZE, 0, NULL, 0);
+	gen_done(s);
+}
+
+void sample_generate_random(SAMPLES * s) {
+	uint64_t base = gen_base();
+	int buckets = (SAMPLE_SIZE + GEN_BUCKET - 1) / GEN_BUCKET;
+	if (buckets == 1) {
+		RNG r;
+		rng_seed(&r, base, 0);
+		gen_run(s, gen_ascending, SAMPLE_SIZE, 0, NULL, 0);
+		shuffle_range(s->data, SAMPLE_SIZE, &r);
+		gen_done(s);
+		return;
+	}
+	int * count = (int *) calloc((size_t) GEN_SLICES * buckets, sizeof(int));
+	int * first = (int *) malloc(((size_t) buckets + 1) * sizeof(int));
+	if (!count || !first) die(1, "Error: Out of memory for shuffling\n");
+	gen_run(s, shuffle_count, SAMPLE_SIZE, base, count, buckets);
+	for (int b = 0, next = 0; b <= buckets; b++) {
+		first[b] = next;
+		for (int t = 0; b < buckets && t < GEN_SLICES; t++) {
+			int * c = &count[(size_t) t * buckets + b], n = *c;
+			*c = next;
+			next += n;
+		}
+	}
+	gen_run(s, shuffle_scatter, SAMPLE_SIZE, base, count, buckets);
+	gen_run(s, shuffle_buckets, buckets, base, first, buckets);
+	free(first);
+	free(count);
+	gen_done(s);
+}
+
+void sample_generate_few(SAMPLES * s) {
+	gen_run(s, gen_few, SAMPLE_SIZE, gen_base(), NULL, 0);
+	gen_done(s);
+}
+
+void sample_generate_sawtooth(SAMPLES * s) {
+	gen_run(s, gen_sawtooth, SAMPLE_SIZE, 0, NULL, 0);
+	gen_done(s);
+}
+
+void sample_generate_organ(SAMPLES * s) {
+	gen_run(s, gen_organ, SAMPLE_SIZE, 0, NULL, 0);
+	gen_done(s);
+}
+
+void sample_generate_nearly(SAMPLES * s) {
+	/* ascending with GEN_PERTURB percent of the samples swapped in pairs */
+	long swaps = (long) SAMPLE_SIZE * GEN_PERTURB / 200;
+	RNG r;
+	rng_seed(&r, gen_base(), 0);
+	gen_run(s, gen_ascending, SAMPLE_SIZE, 0, NULL, 0);
+	for (long k = 0; k < swaps; k++) {
+		int a = (int) rng_below(&r, SAMPLE_SIZE), b = (int) rng_below(&r, SAMPLE_SIZE), t = s->data[a];
+		s->data[a] = s->data[b];
+		s->data[b] = t;
+	}
+	gen_done(s);
+}
+
+void sample_generate_zipf(SAMPLES * s) {
+	gen_run(s, gen_zipf, SAMPLE_SIZE, gen_base(), NULL, 0);
+	gen_done(s);
+}
+
+void sample_generate_equal(SAMPLES * s) {
+	gen_run(s, gen_equal, SAMPLE_SIZE, 0, NULL, 0);
+	gen_done(s);
+}
+
+/*---- DISTRIBUTION REGISTRY ---------------*/
+typedef struct distribution {
+	const char *name;				/* short name used in reports and --dist */
+	const char *label;				/* generate menu entry */
+	void		(*generate)(SAMPLES *);
+	unsigned	layout;				/* LAYOUT_* flag */
+} DISTRIBUTION;
+
+const DISTRIBUTION DISTRIBUTIONS[] = {
+	{ "random",     "Randomized",    sample_generate_random,     LAYOUT_RANDOM     },
+	{ "ascending",  "Ascending",     sample_generate_ascending,  LAYOUT_ASCENDING  },
+	{ "descending", "Descending",    sample_generate_descending, LAYOUT_DESCENDING },
+	{ "few",        "Few Unique",    sample_generate_few,        LAYOUT_RANDOM     },
+	{ "sawtooth",   "Sawtooth",      sample_generate_sawtooth,   LAYOUT_RANDOM     },
+	{ "organ",      "Organ Pipe",    sample_generate_organ,      LAYOUT_RANDOM     },
+	{ "nearly",     "Nearly Sorted", sample_generate_nearly,     LAYOUT_RANDOM     },
+	{ "zipf",       "Zipf",          sample_generate_zipf,       LAYOUT_RANDOM     },
+	{ "equal",      "All Equal",     sample_generate_equal,      LAYOUT_ASCENDING  },
+};
+#define	DISTRIBUTION_COUNT	(int)(sizeof(DISTRIBUTIONS) / sizeof(DISTRIBUTIONS[0]))
+
+bool GEN_PICKED[DISTRIBUTION_COUNT];	/* distributions named with --dist */
+bool GEN_FILTER = false;				/* true when --dist was given */
+int GEN_FIRST = 0;						/* first --dist entry, used for single runs */
+
+/* Parses a comma separated list of distribution names for --dist.
+   Returns false on the first unknown name. */
+bool gen_select(const char * list) {
+	const char * p = list;
+	GEN_FILTER = true;
+	while (*p) {
+		size_t len = strcspn(p, ",");
+		int d = DISTRIBUTION_COUNT;
+		while (--d >= 0)
+			if (strlen(DISTRIBUTIONS[d].name) == len && strncmp(DISTRIBUTIONS[d].name, p, len) == 0) break;
+		if (d < 0) {
+			fprintf(stderr, "Error: Unknown distribution '%.*s'\n", (int) len, p);
+			return false;
+		}
+		if (p == list) GEN_FIRST = d;
+		GEN_PICKED[d] = true;
+		p += len;
+		if (*p == ',') p++;
+	}
+	return true;
+}
+
+bool gen_wanted(int d) {
+	return !GEN_FILTER || GEN_PICKED[d];
+}
+
+/* Generates the first --dist distribution, random by default */
+void sample_generate_first(SAMPLES * s) {
+	DISTRIBUTIONS[GEN_FIRST].generate(s);
+}
+
+bool sample_generate(SAMPLES * s) {
+	int count = DISTRIBUTION_COUNT + 2, back = count - 1, selected = 0;
+	char last = 'A' + DISTRIBUTION_COUNT;
+
+	while (1) {
+		clear();
+		printf(VT_COLOR(220)"GENERATE NEW SAMPLES\n");
+		printf(VT_RESET"--------------------\n");
+
+		for (int i = 0; i < count; i++) {
+			char item[32];
+			if (i == back - 1) {
+				printf(VT_RESET"--------------------\n");
+				continue;
+			}
+			if (i == back) snprintf(item, sizeof(item), "%c. Back", last);
+			else snprintf(item, sizeof(item), "%c. %s", 'A' + i, DISTRIBUTIONS[i].label);
+			if (i == selected) {
+				printf(VT_ATTR(7)"%-20s"VT_DEFAULTATTR"\n", item);
+			} else {
+				printf(VT_COLOR(150)"%c"VT_RESET"%s\n", item[0], item + 1);
+			}
+		}
+
+		printf(VT_RESET"\nUse "VT_ATTR(33)"UP/DOWN"VT_DEFAULTATTR" arrows or "VT_ATTR(33)"A-%c"VT_DEFAULTATTR", press "VT_ATTR(33)"ENTER"VT_DEFAULTATTR" to select\n", last);
+		fflush(stdout);
+
+		int ch = getch_arrow(), choice;
+
+		/* Handle arrow keys */
+		if (ch == 'U') {  /* Up arrow */
+			do {
+				selected = (selected - 1 + count) % count;
+			} while (selected == back - 1);  /* Skip separator */
+			continue;
+		} else if (ch == 'D') {  /* Down arrow */
+			do {
+				selected = (selected + 1) % count;
+			} while (selected == back - 1);  /* Skip separator */
+			continue;
+		} else if (ch == '\n' || ch == '\r') {  /* Enter */
+			choice = (selected == back) ? DISTRIBUTION_COUNT : selected;
+		} else {
+			choice = toupper(ch & 0xFF) - 'A';
+		}
+
+		if (choice == DISTRIBUTION_COUNT) return false;
+		if (choice < 0 || choice > DISTRIBUTION_COUNT) continue;
+		DISTRIBUTIONS[choice].generate(s);
+		return true;
+	}
+}
+
+#endif
@@ -8,8 +8,15 @@
 #else
 	#include <termios.h>
 	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <errno.h>
 #endif
 
+#define	CACHE_LINE		64
+#define	HUGE_PAGE_SIZE	(2UL << 20)
+
 /*---- HELPERS -----------------------------*/
 void die(int code, const char * prompt) {
 	printf("%s", prompt);
@@ -92,4 +99,141 @@ void mssleep(long ms) {
 #endif
 }
 
+/* Monotonic wall-clock time in milliseconds */
+double mstime() {
+#ifndef _WIN32
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000.0 + now.tv_nsec / 1000000.0;
+#else
+	LARGE_INTEGER freq, now;
+	QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return now.QuadPart * 1000.0 / freq.QuadPart;
+#endif
+}
+
+/* Sleeps until the mstime() deadline. Absolute deadlines do not drift
+   with the time spent between sleeps. */
+void sleep_until(double deadline) {
+#if defined(_WIN32) || defined(__APPLE__)
+	double left = deadline - mstime();
+	if (left > 0) mssleep((long)(left + 0.5));
+#else
+	struct timespec at;
+	at.tv_sec = (time_t)(deadline / 1000.0);
+	at.tv_nsec = (long)((deadline - at.tv_sec * 1000.0) * 1000000.0);
+	if (at.tv_nsec >= 1000000000L) { at.tv_sec++; at.tv_nsec -= 1000000000L; }
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &at, NULL) == EINTR);
+#endif
+}
+
+/* Aligned allocation. Blocks of at least HUGE_PAGE_SIZE bytes are aligned to
+   a huge page and, when huge is set, advised for transparent huge pages. */
+void * mem_alloc(size_t size, bool huge) {
+	void * p = NULL;
+	size_t align = (size >= HUGE_PAGE_SIZE) ? HUGE_PAGE_SIZE : CACHE_LINE;
+#ifdef _WIN32
+	p = _aligned_malloc(size ? size : 1, align);
+	(void) huge;
+#else
+	if (posix_memalign(&p, align, size ? size : 1) != 0) return NULL;
+#	ifdef MADV_HUGEPAGE
+	if (huge && align == HUGE_PAGE_SIZE)
+		madvise(p, size, MADV_HUGEPAGE);	/* advisory only, failure is harmless */
+#	else
+	(void) huge;
+#	endif
+#endif
+	return p;
+}
+
+void mem_free(void * p) {
+#ifdef _WIN32
+	_aligned_free(p);
+#else
+	free(p);
+#endif
+}
+
+/* Scratch block kept from one sort to the next and grown on demand, so
+   the sorts that need n more samples do not allocate on every run. One
+   user at a time. */
+static void *	scratchMem = NULL;
+static size_t	scratchSize = 0;
+
+void * scratch_get(size_t size, bool huge) {
+	if (size > scratchSize) {
+		mem_free(scratchMem);
+		scratchMem = mem_alloc(size, huge);
+		scratchSize = scratchMem ? size : 0;
+	}
+	return scratchMem;
+}
+
+/* Read-only view of a whole file, see file_map() */
+typedef struct mapping {
+	const unsigned char *	data;
+	size_t					size;
+	size_t					released;	/* bytes already handed back, see file_release() */
+#ifdef _WIN32
+	HANDLE					file, view;
+#endif
+} MAPPING;
+
+bool file_map(MAPPING * m, const char * path) {
+	memset(m, 0, sizeof(*m));
+#ifdef _WIN32
+	LARGE_INTEGER size;
+	m->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+						  FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (m->file == INVALID_HANDLE_VALUE) return false;
+	if (!GetFileSizeEx(m->file, &size) || size.QuadPart == 0) { CloseHandle(m->file); return false; }
+	m->view = CreateFileMappingA(m->file, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (!m->view) { CloseHandle(m->file); return false; }
+	m->data = (const unsigned char *) MapViewOfFile(m->view, FILE_MAP_READ, 0, 0, 0);
+	if (!m->data) { CloseHandle(m->view); CloseHandle(m->file); return false; }
+	m->size = (size_t) size.QuadPart;
+#else
+	struct stat st;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return false;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return false; }
+	void * p = mmap(NULL, (size_t) st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);							/* the mapping keeps the file open */
+	if (p == MAP_FAILED) return false;
+	madvise(p, (size_t) st.st_size, MADV_SEQUENTIAL);
+	m->data = (const unsigned char *) p;
+	m->size = (size_t) st.st_size;
+#endif
+	return true;
+}
+
+/* Drops the pages before offset from memory, so a sequential reader keeps
+   a bounded resident set however large the file is. */
+void file_release(MAPPING * m, size_t offset) {
+#ifndef _WIN32
+	size_t page = (size_t) sysconf(_SC_PAGESIZE);
+	size_t end = offset / page * page;
+	if (end > m->released) {
+		madvise((void *)(m->data + m->released), end - m->released, MADV_DONTNEED);
+		m->released = end;
+	}
+#else
+	(void) m; (void) offset;			/* the working set manager trims views */
+#endif
+}
+
+void file_unmap(MAPPING * m) {
+	if (!m->data) return;
+#ifdef _WIN32
+	UnmapViewOfFile(m->data);
+	CloseHandle(m->view);
+	CloseHandle(m->file);
+#else
+	munmap((void *) m->data, m->size);
+#endif
+	m->data = NULL;
+}
+
 #endif
@@ -0,0 +1,197 @@
+#ifndef __SORTVIS_LIVE__
+#define __SORTVIS_LIVE__
+
+#include <pthread.h>
+
+/*---- LIVE PLAYBACK -----------------------*/
+/* The sort runs on a worker thread at full speed while this thread draws
+   LIVE_FPS frames per second of whatever state is current. The worker
+   never blocks: each frame the renderer raises a request, the worker
+   answers with a snapshot of the board columns pushed through a single
+   producer, single consumer ring. Neither side takes a lock. Sorts that
+   merge into scratch memory leave the samples stale for whole passes, so
+   the snapshot is taken from the column samples as the event stream left
+   them, the way a replay would show them. */
+
+#define	LIVE_FPS_AUTO		-1		/* per-op replay while every sample has a column */
+#define	LIVE_FPS_DEFAULT	30
+#define	LIVE_RING			4		/* snapshots in flight, power of two */
+
+int LIVE_FPS = LIVE_FPS_AUTO;		/* --fps, 0 forces per-op replay */
+
+typedef struct snapshot {
+	int		values[VIEW_MAX_COLS];	/* samples under the board columns */
+	int		max;
+	long	comparisons, swaps, steals;
+	int		depth;
+	long	aux, moved;
+	long	cache[CACHE_COUNTERS];
+	int		sorted_until, pivot, lo, hi;
+	int		region[REGION_COUNT][2];
+	int		u, v, t;				/* highlights of the last frame event */
+} SNAPSHOT;
+
+typedef struct live {
+	SAMPLES *		s;				/* owned by the worker until done */
+	const ALGORITHM * alg;
+	SNAPSHOT		ring[LIVE_RING];
+	unsigned		head;			/* written by the worker only */
+	unsigned		tail;			/* written by the renderer only */
+	int				want;			/* renderer asks for a snapshot */
+	int				done;			/* worker finished the sort */
+	int				u, v, t;
+	int				cols[VIEW_MAX_COLS];	/* logical samples under the columns */
+	EVENT			last[1];		/* one slot recorder, see live_flush() */
+} LIVE;
+
+static void live_publish(LIVE * l) {
+	unsigned head = l->head;
+	if (head - __atomic_load_n(&l->tail, __ATOMIC_ACQUIRE) == LIVE_RING) return;	/* full */
+	SNAPSHOT * p = &l->ring[head & (LIVE_RING - 1)];
+	const SAMPLES * s = l->s;
+	for (int k = 0; k < BOARD_COLS; k++)
+		p->values[k] = l->cols[k];
+	p->max = s->max;
+	p->comparisons = s->comparisons;
+	p->swaps = s->swaps;
+	p->steals = s->steals;
+	p->depth = s->depth;
+	p->aux = s->aux;
+	p->moved = s->moved;
+	memcpy(p->cache, s->cache, sizeof(p->cache));
+	p->sorted_until = s->sorted_until;
+	p->pivot = s->pivot;
+	p->lo = s->lo;
+	p->hi = s->hi;
+	for (int r = 0; r < REGION_COUNT; r++) {
+		p->region[r][0] = s->region[r].lo;
+		p->region[r][1] = s->region[r].hi;
+	}
+	p->u = l->u; p->v = l->v; p->t = l->t;
+	__atomic_store_n(&l->head, head + 1, __ATOMIC_RELEASE);
+}
+
+static int live_column(int i) {
+	/* board column showing sample i, -1 for samples between columns */
+	int c = (int)(((long long) i * BOARD_COLS + SAMPLE_SIZE - 1) / SAMPLE_SIZE);
+	return (c < BOARD_COLS && sample_at_column(c) == i) ? c : -1;
+}
+
+/* EVENTS.flush of the one slot recorder, called on the worker for every
+   operation. Keeps the latest highlights and column samples and answers
+   frame requests. */
+void live_flush(EVENTS * ev) {
+	LIVE * l = (LIVE *) ev->sink;
+	const EVENT * e = &ev->list[0];
+	int c;
+	cache_event(l->s, e);
+	if (e->op == EV_WRITE && (c = live_column(e->a)) >= 0) l->cols[c] = e->b;
+	if (e->op == EV_SWAP) {
+		/* swaps are in place, the samples hold both values */
+		if ((c = live_column(e->a)) >= 0) l->cols[c] = l->s->data[e->a];
+		if ((c = live_column(e->b)) >= 0) l->cols[c] = l->s->data[e->b];
+	}
+	if (e->op == EV_STEP || e->op == EV_FLASH || e->op == EV_FRAME) { l->u = e->a; l->v = e->b; l->t = e->c; }
+	ev->count = 0;
+	if (__atomic_load_n(&l->want, __ATOMIC_RELAXED)) {
+		__atomic_store_n(&l->want, 0, __ATOMIC_RELAXED);
+		live_publish(l);
+	}
+}
+
+static void * live_worker(void * arg) {
+	LIVE * l = (LIVE *) arg;
+	EVENTS ev = { l->last, 0, 1, live_flush, l };
+	sample_events = &ev;
+	l->alg->sort(l->s);
+	sample_events = NULL;
+	__atomic_store_n(&l->done, 1, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+/* Draws the newest snapshot, if any. view only holds the column samples. */
+static bool live_draw(LIVE * l, SAMPLES * view) {
+	unsigned head = __atomic_load_n(&l->head, __ATOMIC_ACQUIRE);
+	if (head == l->tail) return false;
+	const SNAPSHOT * p = &l->ring[(head - 1) & (LIVE_RING - 1)];
+	for (int k = 0; k < BOARD_COLS; k++)
+		view->data[sample_at_column(k)] = p->values[k];
+	view->max = p->max;
+	view->comparisons = p->comparisons;
+	view->swaps = p->swaps;
+	view->steals = p->steals;
+	view->depth = p->depth;
+	view->aux = p->aux;
+	view->moved = p->moved;
+	memcpy(view->cache, p->cache, sizeof(view->cache));
+	view->sorted_until = p->sorted_until;
+	view->pivot = p->pivot;
+	view->lo = p->lo;
+	view->hi = p->hi;
+	for (int r = 0; r < REGION_COUNT; r++) {
+		view->region[r].lo = p->region[r][0];
+		view->region[r].hi = p->region[r][1];
+	}
+	sample_show(view, p->u, p->v, p->t);
+	__atomic_store_n(&l->tail, head, __ATOMIC_RELEASE);
+	return true;
+}
+
+/* Sorts a copy of origin into sort on a worker thread while animating it.
+   Returns false when the thread could not be started. */
+bool sample_play_live(const ALGORITHM * alg, SAMPLES * origin, SAMPLES * sort) {
+	static LIVE l;
+	SAMPLES view;
+	pthread_t worker;
+	long frame = 1000 / (LIVE_FPS > 0 ? LIVE_FPS : LIVE_FPS_DEFAULT);
+
+	if (!sample_alloc(&view)) return false;
+	memset(&l, 0, sizeof(l));
+	l.s = sort;
+	l.alg = alg;
+	l.u = l.v = l.t = -1;
+	sample_copy(sort, origin);
+	sample_reset(sort);
+	cache_reset();
+	for (int k = 0; k < BOARD_COLS; k++) l.cols[k] = sort->data[sample_at_column(k)];
+	if (pthread_create(&worker, NULL, live_worker, &l) != 0) {
+		sample_free(&view);
+		return false;
+	}
+
+	while (!__atomic_load_n(&l.done, __ATOMIC_ACQUIRE)) {
+		__atomic_store_n(&l.want, 1, __ATOMIC_RELAXED);
+		mssleep(frame);
+		live_draw(&l, &view);
+	}
+	pthread_join(worker, NULL);
+
+	sample_show(sort, -1, -1, -1);			/* the worker is gone, draw the real thing */
+	sample_free(&view);
+	return true;
+}
+
+/* Traces the accesses of one more run on a copy of origin and draws them
+   in the stats panel next to the counts of the animated run */
+void locality_measure(const ALGORITHM * alg, SAMPLES * origin, SAMPLES * sort) {
+	SAMPLES run;
+	if (!LOCALITY_MODE || !sample_alloc(&run)) return;
+	sample_copy(&run, origin);
+	sample_reset(&run);
+	if (locality_run(alg, &run)) memcpy(sort->loc, run.loc, sizeof(run.loc));
+	sample_free(&run);
+	sample_show(sort, -1, -1, -1);
+}
+
+/* Picks timed, per-op replay or live sampling for the menu */
+void sample_animate(const ALGORITHM * alg, SAMPLES * origin, SAMPLES * sort) {
+	bool live = (LIVE_FPS == LIVE_FPS_AUTO) ? SAMPLE_SIZE > VIEW_MAX_COLS : LIVE_FPS > 0;
+	if (DURATION_MS > 0)
+		sample_play_timed(alg, origin, sort);
+	else if (!live || !sample_play_live(alg, origin, sort))
+		sample_play(alg, origin, sort);
+	perf_measure(alg, origin, sort);		/* --perf counts a run without recorder */
+	locality_measure(alg, origin, sort);
+}
+
+#endif
@@ -0,0 +1,203 @@
+#ifndef __SORTVIS_LOCALITY__
+#define __SORTVIS_LOCALITY__
+
+/*---- MEMORY ACCESS LOCALITY --------------*/
+/* The event stream says which samples a sort touches: a comparison reads
+   both operands, a swap reads and writes both, a write stores one, a move
+   to scratch memory reads one and stores its slot, and an access loads or
+   stores one. Scratch memory is one more buffer laid out on its own lines
+   after the samples (see access_address()). Fed through this recorder every
+   access is classed twice, by its stride from the access before it and
+   by its reuse distance, the number of distinct cache lines touched since
+   its own line was last touched. A fully associative LRU cache of C lines
+   hits exactly the accesses with a reuse distance below C, so the reuse
+   histogram reads as hits of caches the size of a common L1, L2 and last
+   level cache, and what is left has to come from memory. Bulk copies are
+   not traced. Recorded runs go without the network base case and radix
+   sort scatters back into the samples, so these are the accesses of the
+   animated sorts. */
+#define	LOC_PAGE		4096			/* bytes per page */
+#define	LOC_L1			(32 << 10)		/* cache sizes the reuse distances are binned by */
+#define	LOC_L2			(1 << 20)
+#define	LOC_LLC			(32 << 20)
+#define	LOC_BLOCK		4096			/* events recorded between two flushes */
+
+enum {
+	LOC_READS, LOC_WRITES,
+	/* stride histogram: next sample, within a line, within a page, farther */
+	LOC_SEQUENTIAL, LOC_NEAR, LOC_PAGE_JUMP, LOC_FAR_JUMP,
+	/* reuse histogram: hits of each cache size, misses, first touches */
+	LOC_REUSE_L1, LOC_REUSE_L2, LOC_REUSE_LLC, LOC_REUSE_MEM, LOC_COLD
+};
+
+const char * LOC_NAMES[LOC_COUNTERS] = {
+	"reads", "writes",
+	"stride_seq", "stride_line", "stride_page", "stride_far",
+	"reuse_l1", "reuse_l2", "reuse_llc", "reuse_mem", "reuse_cold"
+};
+
+bool LOCALITY_MODE = false;			/* --locality: trace the accesses of the sorts */
+
+typedef struct mem_access {
+	int		at;			/* address in ints, see access_address() */
+	int		index;		/* sample the access shows at, -1 for none */
+	bool	store;
+} MEM_ACCESS;
+
+typedef struct locality {
+	long *	out;		/* LOC_COUNTERS counts */
+	int		prev;		/* sample accessed last, -1 before the first */
+	int *	last;		/* per line: time of its latest access, 0 for never */
+	int *	owner;		/* per time: line accessed then, -1 once accessed again */
+	int *	tree;		/* Fenwick tree over times, 1 at the latest access of each line */
+	int		now;		/* time of the latest access */
+	int		slots;		/* times before they are renumbered */
+	int		live;		/* lines touched so far */
+} LOCALITY;
+
+static void locality_mark(LOCALITY * l, int t, int d) {
+	for (; t <= l->slots; t += t & -t) l->tree[t] += d;
+}
+
+static int locality_prefix(LOCALITY * l, int t) {
+	int sum = 0;
+	for (; t > 0; t -= t & -t) sum += l->tree[t];
+	return sum;
+}
+
+static void locality_compact(LOCALITY * l) {
+	/* renumbers the latest accesses 1..live in their order, so times stay
+	   below slots; there are at least as many accesses between two calls
+	   as there are lines */
+	int k = 0;
+	for (int t = 1; t <= l->slots; t++)
+		if (l->owner[t] >= 0) {
+			l->owner[++k] = l->owner[t];
+			l->last[l->owner[k]] = k;
+		}
+	for (int t = 1; t <= l->slots; t++) {
+		if (t > k) l->owner[t] = -1;
+		l->tree[t] = t <= k;
+	}
+	for (int t = 1; t <= l->slots; t++) {
+		int up = t + (t & -t);
+		if (up <= l->slots) l->tree[up] += l->tree[t];
+	}
+	l->now = k;
+}
+
+int access_address(int i, bool scratch) {
+	/* sample i, or slot i of the scratch memory starting on the line after
+	   the samples; -1 for a value held aside */
+	const int line = CACHE_LINE / (int) sizeof(int);
+	if (i < 0) return -1;
+	return scratch ? (SAMPLE_SIZE + line - 1) / line * line + i : i;
+}
+
+int access_limit() {
+	/* addresses stay below this, scratch buffers hold at most SAMPLE_SIZE */
+	return access_address(SAMPLE_SIZE, true);
+}
+
+static void locality_access(LOCALITY * l, int i, bool write) {
+	long * out = l->out;
+	if (i < 0 || i >= access_limit()) return;	/* a value held aside */
+	out[write ? LOC_WRITES : LOC_READS]++;
+
+	if (l->prev >= 0) {
+		size_t d = (size_t) labs((long) i - l->prev) * sizeof(int);
+		out[d <= sizeof(int) ? LOC_SEQUENTIAL : d < CACHE_LINE ? LOC_NEAR : d < LOC_PAGE ? LOC_PAGE_JUMP : LOC_FAR_JUMP]++;
+	}
+	l->prev = i;
+
+	int line = (int)((size_t) i * sizeof(int) / CACHE_LINE);
+	if (l->now == l->slots) locality_compact(l);
+	int t = ++l->now, at = l->last[line];
+	if (at) {
+		size_t lines = (size_t)(l->live - locality_prefix(l, at));
+		out[lines < LOC_L1 / CACHE_LINE ? LOC_REUSE_L1 : lines < LOC_L2 / CACHE_LINE ? LOC_REUSE_L2 :
+			lines < LOC_LLC / CACHE_LINE ? LOC_REUSE_LLC : LOC_REUSE_MEM]++;
+		locality_mark(l, at, -1);
+		l->owner[at] = -1;
+	} else {
+		out[LOC_COLD]++;
+		l->live++;
+	}
+	locality_mark(l, t, 1);
+	l->owner[t] = line;
+	l->last[line] = t;
+}
+
+static int event_access(MEM_ACCESS * m, int i, bool scratch, bool store, int index) {
+	m->at = access_address(i, scratch);
+	m->index = index;
+	m->store = store;
+	return 1;
+}
+
+/* Accesses of an event in the order it makes them. Returns their number,
+   at most 4. */
+int event_accesses(const EVENT * e, MEM_ACCESS m[4]) {
+	bool scratch = (e->c & EV_IN_SCRATCH) != 0;
+	switch (e->op) {
+	case EV_COMPARE:
+		event_access(&m[0], e->a, scratch, false, e->a);
+		return 1 + event_access(&m[1], e->b, scratch, false, e->b);
+	case EV_SWAP:
+		event_access(&m[0], e->a, false, false, e->a);
+		event_access(&m[1], e->b, false, false, e->b);
+		event_access(&m[2], e->a, false, true, e->a);
+		return 3 + event_access(&m[3], e->b, false, true, e->b);
+	case EV_WRITE:
+		return event_access(&m[0], e->a, scratch, true, e->a);
+	case EV_MOVE:
+		event_access(&m[0], e->a, false, false, e->a);
+		return 1 + event_access(&m[1], e->b, true, true, -1);
+	case EV_ACCESS:
+		return event_access(&m[0], e->a, scratch, (e->c & EV_STORE) != 0, scratch ? -1 : e->a);
+	}
+	return 0;
+}
+
+/* EVENTS.flush of the locality run */
+void locality_flush(EVENTS * ev) {
+	LOCALITY * l = (LOCALITY *) ev->sink;
+	MEM_ACCESS m[4];
+	for (size_t k = 0; k < ev->count; k++)
+		for (int n = event_accesses(&ev->list[k], m), j = 0; j < n; j++)
+			locality_access(l, m[j].at, m[j].store);
+	ev->count = 0;
+}
+
+/* Sorts s with the locality recorder attached and leaves the counts in
+   s->loc. Returns false if its tables do not fit in memory. */
+bool locality_run(const ALGORITHM * alg, SAMPLES * s) {
+	size_t lines = ((size_t) access_limit() * sizeof(int) + CACHE_LINE - 1) / CACHE_LINE;
+	LOCALITY l = { s->loc, -1, NULL, NULL, NULL, 0, (int)(2 * lines + 64), 0 };
+	EVENTS ev = { (EVENT *) malloc(LOC_BLOCK * sizeof(EVENT)), 0, LOC_BLOCK, locality_flush, &l };
+	bool ok;
+
+	memset(s->loc, 0, sizeof(s->loc));
+	l.last = (int *) mem_alloc(lines * sizeof(int), USE_HUGE_PAGES);
+	l.owner = (int *) mem_alloc(((size_t) l.slots + 1) * sizeof(int), USE_HUGE_PAGES);
+	l.tree = (int *) mem_alloc(((size_t) l.slots + 1) * sizeof(int), USE_HUGE_PAGES);
+	ok = ev.list && l.last && l.owner && l.tree;
+	if (ok) {
+		memset(l.last, 0, lines * sizeof(int));
+		memset(l.owner, 0xFF, ((size_t) l.slots + 1) * sizeof(int));
+		memset(l.tree, 0, ((size_t) l.slots + 1) * sizeof(int));
+		sample_events = &ev;
+		alg->sort(s);
+		sample_events = NULL;
+		locality_flush(&ev);
+	} else
+		fprintf(stderr, "Note: not enough memory to trace the accesses of %d samples\n", SAMPLE_SIZE);
+
+	mem_free(l.tree);
+	mem_free(l.owner);
+	mem_free(l.last);
+	free(ev.list);
+	return ok;
+}
+
+#endif
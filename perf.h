@@ -0,0 +1,129 @@
+#ifndef __SORTVIS_PERF__
+#define __SORTVIS_PERF__
+
+/*---- HARDWARE COUNTERS -------------------*/
+/* perf_event_open counters around one sort, user space only, counted on
+   the calling thread and inherited by the pool threads it starts later,
+   so the parallel sorts count every worker. They come in two groups, core
+   events and memory events, so each group fits the counters of a common
+   PMU; the kernel multiplexes the groups and each count is scaled by the
+   time it ran. An event the cpu lacks is left out of its group. When
+   nothing can be opened (perf_event_paranoid, a VM without a PMU, not
+   Linux) every counter reads -1, shown as "-", and sorting goes on. */
+#ifdef __linux__
+	#define	PERF_LINUX
+	#include <linux/perf_event.h>
+	#include <sys/syscall.h>
+	#include <sys/ioctl.h>
+#endif
+
+enum { HW_CYCLES, HW_INSTRUCTIONS, HW_BRANCH_MISSES, HW_L1D_MISSES, HW_LLC_MISSES, HW_DTLB_MISSES };
+
+const char * HW_NAMES[HW_COUNTERS] = {
+	"cycles", "instructions", "branch_misses", "l1d_misses", "llc_misses", "dtlb_misses"
+};
+
+bool PERF_MODE = false;				/* --perf: count the sorts */
+
+#ifdef PERF_LINUX
+#define	PERF_GROUPS		2
+#define	PERF_CACHE(cache)	((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const struct {
+	int					group;
+	unsigned			type;
+	unsigned long long	config;
+} PERF_EVENTS[HW_COUNTERS] = {
+	{ 0, PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES         },
+	{ 0, PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS       },
+	{ 0, PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES      },
+	{ 1, PERF_TYPE_HW_CACHE, PERF_CACHE(PERF_COUNT_HW_CACHE_L1D)  },
+	{ 1, PERF_TYPE_HW_CACHE, PERF_CACHE(PERF_COUNT_HW_CACHE_LL)   },
+	{ 1, PERF_TYPE_HW_CACHE, PERF_CACHE(PERF_COUNT_HW_CACHE_DTLB) },
+};
+
+static int	perfFd[HW_COUNTERS];		/* -1 for events not counted */
+static int	perfLeader[PERF_GROUPS];	/* -1 for groups not counted */
+#endif
+static int	perfState = 0;				/* 0 not tried, 1 counting, -1 unavailable */
+
+bool perf_available() {
+	if (perfState) return perfState > 0;
+	perfState = -1;
+#ifdef PERF_LINUX
+	int error = 0, threads = pool.size;
+	pool_stop();						/* workers started from here on inherit the counters */
+	for (int g = 0; g < PERF_GROUPS; g++) perfLeader[g] = -1;
+	for (int k = 0; k < HW_COUNTERS; k++) {
+		struct perf_event_attr attr;
+		int g = PERF_EVENTS[k].group;
+		memset(&attr, 0, sizeof(attr));
+		attr.size = sizeof(attr);
+		attr.type = PERF_EVENTS[k].type;
+		attr.config = PERF_EVENTS[k].config;
+		attr.disabled = perfLeader[g] < 0;
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+		attr.inherit = 1;				/* rules out group reads, each event is read alone */
+		attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+		perfFd[k] = (int) syscall(__NR_perf_event_open, &attr, 0, -1, perfLeader[g], 0);
+		if (perfFd[k] < 0) {
+			if (!error) error = errno;
+			continue;
+		}
+		if (perfLeader[g] < 0) perfLeader[g] = perfFd[k];
+		perfState = 1;
+	}
+	if (threads > 1) pool_start(threads);
+	if (perfState < 0)
+		fprintf(stderr, "Note: hardware counters unavailable (%s), check /proc/sys/kernel/perf_event_paranoid\n",
+				strerror(error));
+#else
+	fprintf(stderr, "Note: hardware counters need Linux perf_event_open\n");
+#endif
+	return perfState > 0;
+}
+
+void perf_start() {
+	if (!PERF_MODE || !perf_available()) return;
+#ifdef PERF_LINUX
+	for (int g = 0; g < PERF_GROUPS; g++)
+		if (perfLeader[g] >= 0) {
+			ioctl(perfLeader[g], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+			ioctl(perfLeader[g], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		}
+#endif
+}
+
+/* Stops counting and stores the counts of the run, -1 for events that
+   were not counted or never got on the PMU */
+void perf_stop(long hw[HW_COUNTERS]) {
+	for (int k = 0; k < HW_COUNTERS; k++) hw[k] = -1;
+	if (!PERF_MODE || perfState <= 0) return;
+#ifdef PERF_LINUX
+	for (int g = 0; g < PERF_GROUPS; g++)
+		if (perfLeader[g] >= 0) ioctl(perfLeader[g], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	for (int k = 0; k < HW_COUNTERS; k++) {
+		/* value, time enabled, time running, summed over the threads */
+		unsigned long long data[3];
+		if (perfFd[k] < 0 || read(perfFd[k], data, sizeof(data)) != sizeof(data) || !data[2]) continue;
+		hw[k] = (long)((double) data[0] * data[1] / data[2]);
+	}
+#endif
+}
+
+/* Sorts a copy of origin once more without a recorder, to count what the
+   sort itself costs, and draws the counts in the stats panel */
+void perf_measure(const ALGORITHM * alg, SAMPLES * origin, SAMPLES * sort) {
+	SAMPLES run;
+	if (!PERF_MODE || !sample_alloc(&run)) return;
+	sample_copy(&run, origin);
+	sample_reset(&run);
+	perf_start();
+	alg->sort(&run);
+	perf_stop(sort->hw);
+	sample_free(&run);
+	sample_show(sort, -1, -1, -1);
+}
+
+#endif
@@ -0,0 +1,163 @@
+#ifndef __SORTVIS_PLAYER__
+#define __SORTVIS_PLAYER__
+
+/*---- EVENT PLAYBACK ----------------------*/
+/* The sort runs first at native speed into a recording, then the recording
+   is applied to a fresh copy of the samples, frame by frame, with the
+   animation delays. Counters are rebuilt from the events themselves. */
+
+void sample_wait(long ms) {
+	/* animation delays only make sense when something is drawn */
+	if (ENABLE_VISUALIZATION) mssleep(ms);
+}
+
+void event_apply(SAMPLES * s, const EVENT * e) {
+	int t;
+	cache_event(s, e);
+	switch (e->op) {
+	case EV_COMPARE:	s->comparisons++; break;
+	case EV_SWAP:		t = s->data[e->a];
+						s->data[e->a] = s->data[e->b];
+						s->data[e->b] = t;
+						s->swaps++;
+						break;
+	case EV_WRITE:		s->data[e->a] = e->b; s->swaps += e->c & EV_COUNTED; break;
+	case EV_MOVE:		s->swaps++; break;
+	case EV_SORTED:		s->sorted_until = e->a; break;
+	case EV_PIVOT:		s->pivot = e->a; break;
+	case EV_BOUNDS:		s->lo = e->a; s->hi = e->b; break;
+	case EV_STEAL:		s->steals++; break;
+	case EV_DEPTH:		s->depth = e->a; break;
+	case EV_AUX:		if ((long) e->a * (long) sizeof(int) > s->aux) s->aux = (long) e->a * sizeof(int);
+						break;
+	case EV_COPY:		s->moved += (long) e->a * sizeof(int); break;
+	case EV_REGION:		s->region[e->c % REGION_COUNT].lo = e->a;
+						s->region[e->c % REGION_COUNT].hi = e->b;
+						break;
+	case EV_STEP:		sample_show(s, e->a, e->b, e->c);
+						sample_wait(SAMPLE_SPEED);
+						break;
+	case EV_FLASH:		sample_show(s, e->a, e->b, e->c);
+						sample_wait(SAMPLE_SPEED / (TRANSITION_FRAMES + 1));
+						break;
+	case EV_FRAME:		sample_show(s, e->a, e->b, e->c); break;
+	}
+}
+
+void events_replay(SAMPLES * s, const EVENTS * ev) {
+	for (size_t i = 0; i < ev->count; i++)
+		event_apply(s, &ev->list[i]);
+}
+
+const ALGORITHM * algorithm_by_key(char key) {
+	for (int a = 0; a < ALGORITHM_COUNT; a++)
+		if (ALGORITHMS[a].key == key) return &ALGORITHMS[a];
+	return NULL;
+}
+
+void sample_play(const ALGORITHM * alg, SAMPLES * origin, SAMPLES * sort) {
+	/* record the sort, then animate the recording from the original order */
+	EVENTS ev = { NULL, 0, 0, NULL, NULL };
+
+	sample_copy(sort, origin);
+	sample_events = &ev;
+	alg->sort(sort);
+	sample_events = NULL;
+
+	sample_copy(sort, origin);
+	sample_reset(sort);
+	cache_reset();
+	events_replay(sort, &ev);
+	events_free(&ev);
+}
+
+/*---- TIMED PLAYBACK ----------------------*/
+/* --duration: the whole animation takes a fixed wall time whatever the
+   algorithm. A first run counts the frames the sort asks for, then the
+   second run draws every k-th of them on absolute deadlines. Frames that
+   are late are dropped rather than shifting everything after them. The
+   events of the second run are applied to a view of the samples, which
+   is drawn instead of the samples the sort leaves stale while it merges
+   into scratch memory. */
+
+#define	DURATION_MAX_FPS	60			/* frames drawn per second at most */
+
+double DURATION_MS = 0;				/* --duration, 0 paces by SAMPLE_SPEED */
+
+typedef struct pacer {
+	SAMPLES *	view;				/* the samples as the events left them */
+	long long	frames;				/* frame events seen */
+	long long	every;				/* draw one frame out of every */
+	double		start, period;		/* deadline of drawn frame n: start + n * period */
+} PACER;
+
+static bool event_is_frame(const EVENT * e) {
+	return e->op == EV_STEP || e->op == EV_FLASH;
+}
+
+/* EVENTS.flush of the counting run */
+void pacer_count(EVENTS * ev) {
+	PACER * p = (PACER *) ev->sink;
+	for (size_t i = 0; i < ev->count; i++)
+		p->frames += event_is_frame(&ev->list[i]);
+	ev->count = 0;
+}
+
+/* EVENTS.flush of the paced run, one event at a time */
+void pacer_show(EVENTS * ev) {
+	PACER * p = (PACER *) ev->sink;
+	const EVENT * e = &ev->list[0];
+	ev->count = 0;
+	if (e->op == EV_FRAME) return;					/* drawn only when paced */
+	if (!event_is_frame(e)) {
+		event_apply(p->view, e);
+		return;
+	}
+	if (++p->frames % p->every) return;
+
+	double deadline = p->start + (double)(p->frames / p->every) * p->period;
+	if (mstime() > deadline + p->period) return;	/* late, catch up */
+	sleep_until(deadline);
+	sample_show(p->view, e->a, e->b, e->c);
+}
+
+void sample_play_timed(const ALGORITHM * alg, SAMPLES * origin, SAMPLES * sort) {
+	EVENT list[4096];
+	SAMPLES view;
+	PACER p = { &view, 0, 1, 0, 0 };
+	EVENTS ev = { list, 0, 4096, pacer_count, &p };
+
+	if (!sample_alloc(&view)) {
+		sample_play(alg, origin, sort);
+		return;
+	}
+	sample_copy(sort, origin);
+	sample_events = &ev;
+	alg->sort(sort);
+	pacer_count(&ev);
+
+	long long budget = (long long)(DURATION_MS * DURATION_MAX_FPS / 1000.0);
+	if (budget < 1) budget = 1;
+	p.every = (p.frames + budget - 1) / budget;
+	if (p.every < 1) p.every = 1;
+	p.period = DURATION_MS / (double)(p.frames / p.every > 0 ? p.frames / p.every : 1);
+	p.frames = 0;
+
+	sample_copy(sort, origin);
+	sample_reset(sort);
+	sample_copy(&view, origin);
+	sample_reset(&view);
+	cache_reset();
+	ev.cap = 1;
+	ev.flush = pacer_show;
+	p.start = mstime();
+	alg->sort(sort);
+	sample_events = NULL;
+
+	sleep_until(p.start + DURATION_MS);
+	memcpy(sort->cache, view.cache, sizeof(sort->cache));
+	sample_free(&view);
+	sample_show(sort, -1, -1, -1);
+}
+
+#endif
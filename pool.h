@@ -0,0 +1,251 @@
+#ifndef __SORTVIS_POOL__
+#define __SORTVIS_POOL__
+
+#include <pthread.h>
+#include <sched.h>
+#ifdef __linux__
+	#include <sys/syscall.h>
+#endif
+
+/*---- THREAD POOL -------------------------*/
+/* Fork-join pool for the parallel algorithms. Every thread owns a deque:
+   it pushes and pops its own tasks at the bottom, newest first, while idle
+   threads steal the oldest (largest) tasks from the top of the others. A
+   thread waiting for a group runs tasks meanwhile, so nested forks never
+   leave it idle and can not deadlock. With one thread everything runs
+   inline. */
+
+#define	POOL_MAX_THREADS	64
+#define	POOL_QUEUE			1024		/* tasks per deque, spawns beyond run inline */
+
+typedef struct task_group {
+	int		pending;					/* spawned tasks not finished yet */
+} TASK_GROUP;
+
+typedef struct task {
+	void	(*run)(void *);
+	void *	arg;
+	TASK_GROUP * group;
+} TASK;
+
+typedef struct deque {
+	pthread_mutex_t	lock;
+	unsigned		top, bottom;		/* thieves take at top, the owner at bottom */
+	TASK			tasks[POOL_QUEUE];
+} DEQUE;
+
+typedef struct pool {
+	pthread_t		threads[POOL_MAX_THREADS];
+	DEQUE			deques[POOL_MAX_THREADS];
+	int				size;				/* threads including the caller */
+	int				queued;				/* tasks in all deques */
+	int				sleepers;			/* workers waiting for tasks */
+	long			steals;				/* tasks run by a thread that did not spawn them */
+	pthread_mutex_t	lock;				/* guards sleeping only */
+	pthread_cond_t	ready;
+	bool			stop;
+} POOL;
+
+int THREADS = 0;						/* --threads, 0 for every online cpu */
+
+static POOL				pool;
+static __thread int		pool_self = 0;	/* 0 on the caller, 1.. on workers */
+
+#define	CPU_PIN_MAX		1024			/* cpus a --pin list may name */
+
+static int				cpu_pinned = 0;	/* cpus cpu_pin kept, 0 when unpinned */
+
+/* Cpus this thread may run on: the affinity mask after --pin or taskset,
+   else every online cpu */
+int cpu_count() {
+	if (cpu_pinned > 0) return cpu_pinned;
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return (int) info.dwNumberOfProcessors;
+#else
+#if defined(__linux__)
+	unsigned long mask[CPU_PIN_MAX / (8 * sizeof(long))];
+	long bytes = syscall(SYS_sched_getaffinity, 0, sizeof mask, mask);
+	if (bytes > 0) {
+		int allowed = 0;
+		for (long w = 0; w < bytes / (long) sizeof(long); w++) allowed += __builtin_popcountl(mask[w]);
+		if (allowed > 0) return allowed;
+	}
+#endif
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (int) n : 1;
+#endif
+}
+
+/* Parses a cpu list such as "2" or "0,4-7" into mask. Returns false when
+   it is malformed or names a cpu from CPU_PIN_MAX up. */
+bool cpu_list(const char * list, unsigned long mask[CPU_PIN_MAX / (8 * sizeof(long))]) {
+	const int bits = 8 * sizeof(long);
+	const char * p = list;
+	memset(mask, 0, CPU_PIN_MAX / 8);
+	while (*p) {
+		char * end;
+		long lo = strtol(p, &end, 10), hi = lo;
+		if (end == p) return false;
+		if (*end == '-') {
+			p = end + 1;
+			hi = strtol(p, &end, 10);
+			if (end == p) return false;
+		}
+		if (lo < 0 || hi < lo || hi >= CPU_PIN_MAX || (*end != ',' && *end != '\0')) return false;
+		for (long c = lo; c <= hi; c++) mask[c / bits] |= 1UL << (c % bits);
+		p = (*end == ',') ? end + 1 : end;
+	}
+	return list[0] != '\0';
+}
+
+/* Keeps the calling thread, and the pool threads it starts later, on the
+   cpus of mask, which cpu_count then reports so the pool is sized to
+   them. Returns false where affinity can not be set. */
+bool cpu_pin(const unsigned long mask[CPU_PIN_MAX / (8 * sizeof(long))]) {
+#if defined(__linux__)
+	return syscall(SYS_sched_setaffinity, 0, CPU_PIN_MAX / 8, mask) == 0;
+#elif defined(_WIN32)
+	const int bits = 8 * sizeof(long);
+	DWORD_PTR set = 0;
+	for (int c = 0; c < CPU_PIN_MAX; c++)
+		if ((mask[c / bits] >> (c % bits)) & 1) {
+			if (c >= (int)(8 * sizeof(DWORD_PTR))) return false;	/* beyond one processor group */
+			set |= (DWORD_PTR) 1 << c;
+		}
+	if (!set || SetThreadAffinityMask(GetCurrentThread(), set) == 0) return false;
+	cpu_pinned = __builtin_popcountll((unsigned long long) set);
+	return true;
+#else
+	(void) mask;
+	return false;
+#endif
+}
+
+static bool pool_pop(DEQUE * d, TASK * t, bool steal) {
+	bool got = false;
+	pthread_mutex_lock(&d->lock);
+	if (d->top != d->bottom) {
+		*t = steal ? d->tasks[d->top++ % POOL_QUEUE] : d->tasks[--d->bottom % POOL_QUEUE];
+		got = true;
+	}
+	pthread_mutex_unlock(&d->lock);
+	return got;
+}
+
+static bool pool_take(TASK * t) {
+	/* own tasks first, then the other deques starting after ours */
+	if (!__atomic_load_n(&pool.queued, __ATOMIC_SEQ_CST)) return false;
+	bool got = pool_pop(&pool.deques[pool_self], t, false);
+	for (int k = 1; !got && k < pool.size; k++)
+		if (pool_pop(&pool.deques[(pool_self + k) % pool.size], t, true))
+			got = true, __atomic_fetch_add(&pool.steals, 1, __ATOMIC_RELAXED);
+	if (got) __atomic_fetch_sub(&pool.queued, 1, __ATOMIC_SEQ_CST);
+	return got;
+}
+
+static void pool_finish(TASK * t) {
+	t->run(t->arg);
+	__atomic_fetch_sub(&t->group->pending, 1, __ATOMIC_RELEASE);
+}
+
+static void * pool_worker(void * arg) {
+	TASK t;
+	pool_self = (int)(size_t) arg;
+	while (!__atomic_load_n(&pool.stop, __ATOMIC_ACQUIRE)) {
+		if (pool_take(&t)) {
+			pool_finish(&t);
+			continue;
+		}
+		pthread_mutex_lock(&pool.lock);
+		__atomic_fetch_add(&pool.sleepers, 1, __ATOMIC_SEQ_CST);
+		while (!pool.stop && !__atomic_load_n(&pool.queued, __ATOMIC_SEQ_CST))
+			pthread_cond_wait(&pool.ready, &pool.lock);
+		__atomic_fetch_sub(&pool.sleepers, 1, __ATOMIC_SEQ_CST);
+		pthread_mutex_unlock(&pool.lock);
+	}
+	return NULL;
+}
+
+void pool_stop() {
+	if (pool.size <= 1) { pool.size = 0; return; }
+	pthread_mutex_lock(&pool.lock);
+	__atomic_store_n(&pool.stop, true, __ATOMIC_RELEASE);
+	pthread_cond_broadcast(&pool.ready);
+	pthread_mutex_unlock(&pool.lock);
+	for (int i = 1; i < pool.size; i++)
+		pthread_join(pool.threads[i], NULL);
+	for (int i = 0; i < pool.size; i++)
+		pthread_mutex_destroy(&pool.deques[i].lock);
+	pthread_cond_destroy(&pool.ready);
+	pthread_mutex_destroy(&pool.lock);
+	pool.size = 0;
+	events_shared = false;
+}
+
+/* (Re)starts the pool with n threads counting the caller, 0 for THREADS */
+void pool_start(int n) {
+	if (n <= 0) n = THREADS > 0 ? THREADS : cpu_count();
+	if (n > POOL_MAX_THREADS) n = POOL_MAX_THREADS;
+	if (n == pool.size) return;
+	pool_stop();
+	pool.queued = pool.sleepers = 0;
+	pool.stop = false;
+	pool.size = 1;
+	if (n == 1) return;
+	pthread_mutex_init(&pool.lock, NULL);
+	pthread_cond_init(&pool.ready, NULL);
+	for (int i = 0; i < n; i++) {
+		pool.deques[i].top = pool.deques[i].bottom = 0;
+		pthread_mutex_init(&pool.deques[i].lock, NULL);
+	}
+	for (int i = 1; i < n; i++) {
+		if (pthread_create(&pool.threads[i], NULL, pool_worker, (void *)(size_t) i) != 0) break;
+		pool.size++;
+	}
+	events_shared = pool.size > 1;
+}
+
+int pool_size() {
+	if (!pool.size) pool_start(0);
+	return pool.size;
+}
+
+long pool_steals() {
+	return __atomic_load_n(&pool.steals, __ATOMIC_RELAXED);
+}
+
+void pool_spawn(TASK_GROUP * g, void (*run)(void *), void * arg) {
+	if (pool_size() > 1) {
+		DEQUE * d = &pool.deques[pool_self];
+		pthread_mutex_lock(&d->lock);
+		if (d->bottom - d->top < POOL_QUEUE) {
+			TASK * t = &d->tasks[d->bottom++ % POOL_QUEUE];
+			t->run = run;
+			t->arg = arg;
+			t->group = g;
+			__atomic_fetch_add(&g->pending, 1, __ATOMIC_RELAXED);
+			pthread_mutex_unlock(&d->lock);
+			__atomic_fetch_add(&pool.queued, 1, __ATOMIC_SEQ_CST);
+			if (__atomic_load_n(&pool.sleepers, __ATOMIC_SEQ_CST)) {
+				pthread_mutex_lock(&pool.lock);
+				pthread_cond_signal(&pool.ready);
+				pthread_mutex_unlock(&pool.lock);
+			}
+			return;
+		}
+		pthread_mutex_unlock(&d->lock);
+	}
+	run(arg);								/* single thread or deque full */
+}
+
+void pool_wait(TASK_GROUP * g) {
+	TASK t;
+	while (__atomic_load_n(&g->pending, __ATOMIC_ACQUIRE) > 0) {
+		if (pool_take(&t)) pool_finish(&t);
+		else sched_yield();
+	}
+}
+
+#endif
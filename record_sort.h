@@ -0,0 +1,128 @@
+/* Sorts for one record type, included once per type by records.h.
+   Expects REC_T (a struct with an unsigned key field), REC_KEY (the key
+   type) and REC_FN(name) (the prefixed function name). With REC_PAIR and
+   REC_PAIR_FN, the key-index type of the same key and its prefix, it also
+   generates the test data, the check and the entry points of the record
+   registry. No include guard on purpose. */
+
+#define	REC_MIN(a, b)	((a) < (b) ? (a) : (b))
+
+static void REC_FN(insertion)(REC_T * a, size_t n) {
+	for (size_t i = 1; i < n; i++) {
+		REC_T v = a[i];
+		size_t j = i;
+		for (; j > 0 && v.key < a[j - 1].key; j--) a[j] = a[j - 1];
+		a[j] = v;
+	}
+}
+
+/* Bottom-up merge sort, stable, tmp holds n records */
+static void REC_FN(merge)(REC_T * a, REC_T * tmp, size_t n) {
+	REC_T * src = a, * dst = tmp, * t;
+	for (size_t b = 0; b < n; b += RECORD_RUN) REC_FN(insertion)(a + b, REC_MIN(RECORD_RUN, n - b));
+	for (size_t w = RECORD_RUN; w < n; w <<= 1, t = src, src = dst, dst = t) {
+		for (size_t lo = 0; lo < n; lo += 2 * w) {
+			size_t mid = REC_MIN(lo + w, n), hi = REC_MIN(lo + 2 * w, n), i = lo, j = mid, k = lo;
+			while (i < mid && j < hi) dst[k++] = (src[j].key < src[i].key) ? src[j++] : src[i++];
+			memcpy(dst + k, src + i, (mid - i) * sizeof(REC_T));
+			k += mid - i;
+			memcpy(dst + k, src + j, (hi - j) * sizeof(REC_T));
+		}
+	}
+	if (src != a) memcpy(a, src, n * sizeof(REC_T));
+}
+
+/* LSD radix sort on 8-bit digits, stable, one histogram pass for all of
+   them and no pass for a digit every key shares */
+static void REC_FN(radix)(REC_T * a, REC_T * tmp, size_t n) {
+	size_t count[sizeof(REC_KEY)][256];
+	REC_T * src = a, * dst = tmp, * t;
+	memset(count, 0, sizeof(count));
+	for (size_t i = 0; i < n; i++)
+		for (unsigned d = 0; d < sizeof(REC_KEY); d++) count[d][(a[i].key >> (8 * d)) & 0xFF]++;
+	for (unsigned d = 0; n && d < sizeof(REC_KEY); d++) {
+		size_t * c = count[d], next = 0;
+		if (c[(a[0].key >> (8 * d)) & 0xFF] == n) continue;
+		for (int v = 0; v < 256; v++) {
+			size_t k = c[v];
+			c[v] = next;
+			next += k;
+		}
+		for (size_t i = 0; i < n; i++) dst[c[(src[i].key >> (8 * d)) & 0xFF]++] = src[i];
+		t = src, src = dst, dst = t;
+	}
+	if (src != a) memcpy(a, src, n * sizeof(REC_T));
+}
+
+#ifdef REC_PAIR
+/* Keys come from the index, the payload repeats its low byte after the
+   index, so check() can tell a record that was torn or duplicated */
+static REC_KEY REC_FN(key)(uint64_t base, uint32_t i) {
+	uint64_t x = base + i;
+	return (REC_KEY) rng_mix(&x);
+}
+
+static void REC_FN(fill)(void * data, size_t n, uint64_t base) {
+	REC_T * a = (REC_T *) data;
+	for (size_t i = 0; i < n; i++) {
+		uint32_t index = (uint32_t) i;
+		a[i].key = REC_FN(key)(base, index);
+		memcpy(a[i].payload, &index, sizeof(index));
+		memset(a[i].payload + sizeof(index), index & 0xFF, sizeof(a[i].payload) - sizeof(index));
+	}
+}
+
+static bool REC_FN(check)(const void * data, size_t n, uint64_t base) {
+	/* sorted, stable and every record whole */
+	const REC_T * a = (const REC_T *) data;
+	uint32_t last = 0;
+	for (size_t i = 0; i < n; i++) {
+		uint32_t index;
+		memcpy(&index, a[i].payload, sizeof(index));
+		if (a[i].key != REC_FN(key)(base, index)) return false;
+		for (size_t b = sizeof(index); b < sizeof(a[i].payload); b++)
+			if (a[i].payload[b] != (unsigned char)(index & 0xFF)) return false;
+		if (i && (a[i].key < a[i - 1].key || (a[i].key == a[i - 1].key && index < last))) return false;
+		last = index;
+	}
+	return true;
+}
+
+/* Indirect sort: the (key, index) pairs are sorted, then the records are
+   permuted in place along the cycles of the permutation, so each record
+   moves once and no second record buffer is needed */
+static void REC_FN(indirect)(void * data, void * pairs, void * tmp, size_t n, int alg) {
+	REC_T * a = (REC_T *) data;
+	REC_PAIR * p = (REC_PAIR *) pairs;
+	for (size_t i = 0; i < n; i++) {
+		p[i].key = a[i].key;
+		p[i].index = (uint32_t) i;
+	}
+	if (alg == RECORD_RADIX) REC_PAIR_FN(radix)(p, (REC_PAIR *) tmp, n);
+	else REC_PAIR_FN(merge)(p, (REC_PAIR *) tmp, n);
+	for (size_t i = 0; i < n; i++) {
+		if (p[i].index == i) continue;
+		REC_T hold = a[i];
+		size_t j = i, k;
+		while ((k = p[j].index) != i) {
+			a[j] = a[k];
+			p[j].index = (uint32_t) j;
+			j = k;
+		}
+		a[j] = hold;
+		p[j].index = (uint32_t) j;
+	}
+}
+
+static void REC_FN(direct)(void * data, void * tmp, size_t n, int alg) {
+	if (alg == RECORD_RADIX) REC_FN(radix)((REC_T *) data, (REC_T *) tmp, n);
+	else REC_FN(merge)((REC_T *) data, (REC_T *) tmp, n);
+}
+#endif
+
+#undef	REC_MIN
+#undef	REC_T
+#undef	REC_KEY
+#undef	REC_FN
+#undef	REC_PAIR
+#undef	REC_PAIR_FN
@@ -0,0 +1,114 @@
+#ifndef __SORTVIS_RECORDS__
+#define __SORTVIS_RECORDS__
+
+/*---- RECORD SORTS ------------------------*/
+/* The animated algorithms move bare int samples. Real rows are records:
+   an unsigned 32 or 64-bit key and a payload, 16 to 128 bytes in all.
+   record_sort.h is a template included once per record type; it makes a
+   stable merge sort and an LSD radix sort that move whole records, and an
+   indirect sort that orders compact (key, index) pairs with the same
+   algorithms and then permutes the records once. */
+#define	RECORD_RUN		8			/* records sorted by insertion before merging */
+
+enum { RECORD_MERGE, RECORD_RADIX, RECORD_ALG_COUNT };
+const char * RECORD_ALGS[RECORD_ALG_COUNT] = { "merge", "radix" };
+
+#define	RECORD(key_t, bytes)	struct { key_t key; unsigned char payload[(bytes) - sizeof(key_t)]; }
+
+typedef struct { uint32_t key, index; } PAIR32;
+typedef struct { uint64_t key; uint32_t index; } PAIR64;
+typedef RECORD(uint32_t, 16)	REC32_16;
+typedef RECORD(uint32_t, 32)	REC32_32;
+typedef RECORD(uint32_t, 64)	REC32_64;
+typedef RECORD(uint32_t, 128)	REC32_128;
+typedef RECORD(uint64_t, 16)	REC64_16;
+typedef RECORD(uint64_t, 32)	REC64_32;
+typedef RECORD(uint64_t, 64)	REC64_64;
+typedef RECORD(uint64_t, 128)	REC64_128;
+
+#define	REC_T			PAIR32
+#define	REC_KEY			uint32_t
+#define	REC_FN(name)	pair32_##name
+#include "record_sort.h"
+
+#define	REC_T			PAIR64
+#define	REC_KEY			uint64_t
+#define	REC_FN(name)	pair64_##name
+#include "record_sort.h"
+
+#define	REC_T			REC32_16
+#define	REC_KEY			uint32_t
+#define	REC_FN(name)	rec32_16_##name
+#define	REC_PAIR		PAIR32
+#define	REC_PAIR_FN(name)	pair32_##name
+#include "record_sort.h"
+
+#define	REC_T			REC32_32
+#define	REC_KEY			uint32_t
+#define	REC_FN(name)	rec32_32_##name
+#define	REC_PAIR		PAIR32
+#define	REC_PAIR_FN(name)	pair32_##name
+#include "record_sort.h"
+
+#define	REC_T			REC32_64
+#define	REC_KEY			uint32_t
+#define	REC_FN(name)	rec32_64_##name
+#define	REC_PAIR		PAIR32
+#define	REC_PAIR_FN(name)	pair32_##name
+#include "record_sort.h"
+
+#define	REC_T			REC32_128
+#define	REC_KEY			uint32_t
+#define	REC_FN(name)	rec32_128_##name
+#define	REC_PAIR		PAIR32
+#define	REC_PAIR_FN(name)	pair32_##name
+#include "record_sort.h"
+
+#define	REC_T			REC64_16
+#define	REC_KEY			uint64_t
+#define	REC_FN(name)	rec64_16_##name
+#define	REC_PAIR		PAIR64
+#define	REC_PAIR_FN(name)	pair64_##name
+#include "record_sort.h"
+
+#define	REC_T			REC64_32
+#define	REC_KEY			uint64_t
+#define	REC_FN(name)	rec64_32_##name
+#define	REC_PAIR		PAIR64
+#define	REC_PAIR_FN(name)	pair64_##name
+#include "record_sort.h"
+
+#define	REC_T			REC64_64
+#define	REC_KEY			uint64_t
+#define	REC_FN(name)	rec64_64_##name
+#define	REC_PAIR		PAIR64
+#define	REC_PAIR_FN(name)	pair64_##name
+#include "record_sort.h"
+
+#define	REC_T			REC64_128
+#define	REC_KEY			uint64_t
+#define	REC_FN(name)	rec64_128_##name
+#define	REC_PAIR		PAIR64
+#define	REC_PAIR_FN(name)	pair64_##name
+#include "record_sort.h"
+
+typedef struct record_type {
+	int			key_bits;
+	int			bytes;				/* whole record */
+	int			pair_bytes;			/* (key, index) pair of the indirect sort */
+	void		(*fill)(void * a, size_t n, uint64_t base);
+	bool		(*check)(const void * a, size_t n, uint64_t base);
+	void		(*direct)(void * a, void * tmp, size_t n, int alg);
+	void		(*indirect)(void * a, void * pairs, void * tmp, size_t n, int alg);
+} RECORD_TYPE;
+
+#define	RECORD_ENTRY(k, b)	{ k, b, sizeof(PAIR##k), rec##k##_##b##_fill, rec##k##_##b##_check, \
+							  rec##k##_##b##_direct, rec##k##_##b##_indirect }
+
+const RECORD_TYPE RECORD_TYPES[] = {
+	RECORD_ENTRY(32, 16), RECORD_ENTRY(32, 32), RECORD_ENTRY(32, 64), RECORD_ENTRY(32, 128),
+	RECORD_ENTRY(64, 16), RECORD_ENTRY(64, 32), RECORD_ENTRY(64, 64), RECORD_ENTRY(64, 128),
+};
+#define	RECORD_TYPE_COUNT	(int)(sizeof(RECORD_TYPES) / sizeof(RECORD_TYPES[0]))
+
+#endif
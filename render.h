@@ -0,0 +1,461 @@
+#ifndef __SORTVIS_RENDER__
+#define __SORTVIS_RENDER__
+
+/*---- BOARD GEOMETRY ----------------------*/
+int sample_column(int i) {
+	/* board column showing sample i */
+	return (int)((long long) i * BOARD_COLS / SAMPLE_SIZE);
+}
+
+int sample_at_column(int c) {
+	/* sample shown by board column c */
+	return (int)((long long) c * SAMPLE_SIZE / BOARD_COLS);
+}
+
+int sample_rows(SAMPLES * s) {
+	return (s->max < VIEW_MAX_ROWS) ? s->max : VIEW_MAX_ROWS;
+}
+
+int sample_height(SAMPLES * s, int i) {
+	/* number of empty rows above the bar of sample i */
+	int rows = sample_rows(s);
+	return rows - (int)(((long long) s->data[i] * rows + s->max - 1) / s->max);
+}
+
+int sample_shade(SAMPLES * s, int i) {
+	return (int)((long long)(s->data[i] - 1) * SHADE_COUNT / s->max);
+}
+
+bool sample_in_column(int i, int c) {
+	return i >= 0 && sample_column(i) == c;
+}
+
+int sample_label(SAMPLES * s, int i) {
+	/* values wider than 3 digits are labelled in percent of the maximum */
+	return (s->max > 999) ? (int)((long long) s->data[i] * 100 / s->max) : s->data[i];
+}
+
+/*---- FRAME BUILDER -----------------------*/
+/* Append-only output buffer. Every put is a memcpy at the end of the
+   frame, so building a frame is linear in its length. */
+typedef struct frame {
+	char *	buf;
+	size_t	len;
+	size_t	cap;
+} FRAME;
+
+static FRAME	screen;						/* output buffer for one frame */
+
+void frame_reserve(FRAME * f, size_t extra) {
+	if (f->len + extra <= f->cap) return;
+	size_t cap = f->cap ? f->cap : 4096;
+	while (cap < f->len + extra) cap <<= 1;
+	char * buf = (char *) realloc(f->buf, cap);
+	if (!buf) die(1, "Error: Out of memory for frame buffer\n");
+	f->buf = buf;
+	f->cap = cap;
+}
+
+void frame_put(FRAME * f, const char * s, size_t n) {
+	frame_reserve(f, n);
+	memcpy(f->buf + f->len, s, n);
+	f->len += n;
+}
+
+#define	frame_puts(f, s)	frame_put(f, s, strlen(s))
+
+void frame_putc(FRAME * f, char c, int n) {
+	frame_reserve(f, n);
+	memset(f->buf + f->len, c, n);
+	f->len += n;
+}
+
+void frame_num(FRAME * f, long v, int width) {
+	/* right aligned decimal, padded with spaces to width */
+	char digits[24];
+	int n = 0;
+	bool neg = v < 0;
+	unsigned long u = neg ? 0UL - (unsigned long) v : (unsigned long) v;
+	do { digits[sizeof(digits) - ++n] = (char)('0' + u % 10); u /= 10; } while (u);
+	if (neg) digits[sizeof(digits) - ++n] = '-';
+	if (width > n) frame_putc(f, ' ', width - n);
+	frame_put(f, digits + sizeof(digits) - n, n);
+}
+
+void frame_goto(FRAME * f, int row, int col) {
+	frame_put(f, "\x1B[", 2);
+	frame_num(f, row, 0);
+	frame_putc(f, ';', 1);
+	frame_num(f, col, 0);
+	frame_putc(f, 'H', 1);
+}
+
+/*---- PRE-ENCODED CELLS -------------------*/
+/* color + glyph pairs are encoded once per palette, not once per cell */
+typedef struct cell_code {
+	char	text[32];
+	int		len;
+} CELL_CODE;
+
+enum { CELL_SHADE, CELL_BLOCK };
+
+/* --cache bars: last access served by L1, L2, L3, memory */
+const char * CACHE_COLOR[CACHE_MEMORY] = { VT_COLOR(46), VT_COLOR(226), VT_COLOR(208), VT_COLOR(196) };
+enum { MARK_NONE, MARK_CURRENT, MARK_RUNNING, MARK_EXTRA };
+
+static CELL_CODE	barCell[SHADE_COUNT + CACHE_MEMORY][2];	/* colored VSHADE and VBLOCK pairs, then
+															   the CACHE_COLOR ones */
+static CELL_CODE	markCell[4];				/* index row glyph pairs */
+static CELL_CODE	sepLine;					/* one VBAR */
+static SHADES		cellPalette;				/* palette barCell was encoded with */
+static bool			cellsReady = false;
+
+void cell_encode(CELL_CODE * cell, const char * color, int glyph, int count) {
+	int n = snprintf(cell->text, sizeof(cell->text), "%s", color), r;
+	while (count--) {
+		r = snprintf(cell->text + n, sizeof(cell->text) - n, "%lc", (wint_t) glyph);
+		if (r > 0) n += r;		/* glyphs the locale cannot encode are dropped */
+	}
+	cell->len = n;
+}
+
+void cells_prepare() {
+	const int marks[4] = { 32, VCURRENT, VRUNNING, VEXTRA };
+	int i;
+
+	if (cellsReady && memcmp(cellPalette, colors, sizeof(SHADES)) == 0) return;
+	for (i = 0; i < SHADE_COUNT + CACHE_MEMORY; i++) {
+		const char * color = (i < SHADE_COUNT) ? colors[i] : CACHE_COLOR[i - SHADE_COUNT];
+		cell_encode(&barCell[i][CELL_SHADE], color, VSHADE, 2);
+		cell_encode(&barCell[i][CELL_BLOCK], color, VBLOCK, 2);
+	}
+	for (i = 0; i < 4; i++)
+		cell_encode(&markCell[i], "", marks[i], 2);
+	cell_encode(&sepLine, "", VBAR, 1);
+	memcpy(cellPalette, colors, sizeof(SHADES));
+	cellsReady = true;
+}
+
+#define	frame_cell(f, c)	frame_put(f, (c)->text, (c)->len)
+
+/*---- BOARD STATE -------------------------*/
+bool DIFF_RENDERING = true;		/* redraw only the cells that changed since the last frame */
+
+/* terminal rows (1-based) of the board parts */
+#define	BOARD_TOP			3					/* first bar row */
+#define	BOARD_VALUES(rows)	(BOARD_TOP + (rows) + 1)
+#define	BOARD_INDICES(rows)	(BOARD_TOP + (rows) + 2)
+#define	BOARD_STATS(line)	(2 + (line))		/* stats panel line to terminal row */
+
+enum { LABEL_NORMAL, LABEL_CURRENT, LABEL_SORTED, LABEL_SWAPPED, LABEL_PIVOT, LABEL_OUTSIDE, LABEL_THREAD };
+
+const char * LABEL_STYLE[] = {
+	VT_COLOR(244),
+	VT_ATTR(1) VT_COLOR(226),
+	VT_COLOR(46),
+	VT_COLOR(51),
+	VT_ATTR(1) VT_COLOR(201),
+	VT_COLOR(238),
+	/* LABEL_THREAD + thread, one per REGION_COUNT */
+	VT_COLOR(209), VT_COLOR(141), VT_COLOR(114), VT_COLOR(75),
+	VT_COLOR(222), VT_COLOR(204), VT_COLOR(80), VT_COLOR(183),
+};
+
+int sample_owner(SAMPLES * s, int i) {
+	/* thread whose region holds sample i, -1 for none */
+	for (int r = 0; r < REGION_COUNT; r++)
+		if (i >= s->region[r].lo && i <= s->region[r].hi) return r;
+	return -1;
+}
+
+typedef struct board_column {
+	int		shade;		/* color of the bar */
+	int		height;		/* empty rows above the bar */
+	int		label;		/* number printed below the bar */
+	int		style;		/* LABEL_* of the number */
+	int		mark;		/* MARK_* glyph in the index row */
+} BOARD_COLUMN;
+
+static BOARD_COLUMN	board[VIEW_MAX_COLS];	/* frame being drawn */
+static BOARD_COLUMN	shown[VIEW_MAX_COLS];	/* frame currently on screen */
+static int			shownRows;				/* bar rows currently on screen */
+static long			shownCmp, shownSwp;		/* counters currently on screen */
+
+/* optional stats stacked below CMP and SWP once they are above zero */
+enum {
+	STAT_CACHE, STAT_DEPTH = STAT_CACHE + CACHE_COUNTERS, STAT_STEALS, STAT_AUX, STAT_MOVED, STAT_HW,
+	STAT_READS = STAT_HW + HW_COUNTERS, STAT_WRITES, STAT_NEAR, STAT_FAR, STAT_MISS, STAT_COUNT
+};
+
+static const char * const STAT_LABEL[STAT_COUNT] = {
+	/* modelled hits and misses per level, counted live with --cache */
+	VT_COLOR(244) "1HT:" VT_COLOR(46),
+	VT_COLOR(244) "1MS:" VT_COLOR(226),
+	VT_COLOR(244) "2HT:" VT_COLOR(226),
+	VT_COLOR(244) "2MS:" VT_COLOR(208),
+	VT_COLOR(244) "3HT:" VT_COLOR(208),
+	VT_COLOR(244) "3MS:" VT_COLOR(196),
+	VT_COLOR(244) "DEP:" VT_COLOR(78),
+	VT_COLOR(244) "STL:" VT_COLOR(141),
+	VT_COLOR(244) "AUX:" VT_COLOR(180),
+	VT_COLOR(244) "MOV:" VT_COLOR(180),
+	/* hardware counters in perf.h order, after a --perf run */
+	VT_COLOR(244) "CYC:" VT_COLOR(110),
+	VT_COLOR(244) "INS:" VT_COLOR(110),
+	VT_COLOR(244) "BRM:" VT_COLOR(110),
+	VT_COLOR(244) "L1M:" VT_COLOR(110),
+	VT_COLOR(244) "LLM:" VT_COLOR(110),
+	VT_COLOR(244) "TLB:" VT_COLOR(110),
+	/* after a --locality run: reads, writes, percent of strides within a
+	   cache line and beyond a page, percent of accesses a last level
+	   cache would miss */
+	VT_COLOR(244) "RDS:" VT_COLOR(150),
+	VT_COLOR(244) "WRS:" VT_COLOR(150),
+	VT_COLOR(244) "NR%:" VT_COLOR(150),
+	VT_COLOR(244) "FR%:" VT_COLOR(150),
+	VT_COLOR(244) "MS%:" VT_COLOR(150),
+};
+
+static long			shownStat[STAT_COUNT];
+
+static long stat_percent(long part, long whole) {
+	return whole > 0 ? part * 100 / whole : 0;
+}
+
+static long stat_value(SAMPLES * s, int k) {
+	const long * loc = s->loc;
+	long strides = loc[LOC_SEQUENTIAL] + loc[LOC_NEAR] + loc[LOC_PAGE_JUMP] + loc[LOC_FAR_JUMP];
+	switch (k) {
+	case STAT_DEPTH:	return s->depth;
+	case STAT_STEALS:	return s->steals;
+	case STAT_AUX:		return s->aux;
+	case STAT_MOVED:	return s->moved;
+	case STAT_READS:	return loc[LOC_READS];
+	case STAT_WRITES:	return loc[LOC_WRITES];
+	case STAT_NEAR:		return stat_percent(loc[LOC_SEQUENTIAL] + loc[LOC_NEAR], strides);
+	case STAT_FAR:		return stat_percent(loc[LOC_FAR_JUMP], strides);
+	case STAT_MISS:		return stat_percent(loc[LOC_REUSE_MEM] + loc[LOC_COLD], loc[LOC_READS] + loc[LOC_WRITES]);
+	default:			return (k < STAT_DEPTH) ? s->cache[k - STAT_CACHE] : s->hw[k - STAT_HW];
+	}
+}
+
+static int stat_at(SAMPLES * s, int n) {
+	/* the n-th optional stat that is shown, -1 past the last */
+	for (int k = 0; k < STAT_COUNT; k++)
+		if (stat_value(s, k) > 0 && n-- == 0) return k;
+	return -1;
+}
+
+void board_build(SAMPLES * s, int u, int v, int t) {
+	static int last_u = -1, last_v = -1;  /* Track last swap for highlighting */
+	int i, k, owner;
+
+	for (k = 0; k < BOARD_COLS; k++) {
+		BOARD_COLUMN * b = &board[k];
+		i = sample_at_column(k);
+		b->shade  = cache_served(i) ? SHADE_COUNT + cache_served(i) - 1	/* --cache: where its last access came from */
+								  : sample_shade(s, i);
+		b->height = sample_height(s, i);
+		b->label  = sample_label(s, i);
+
+		if (sample_in_column(u, k) || sample_in_column(v, k))
+			b->style = LABEL_CURRENT;		/* Current comparison - bright yellow */
+		else if (sample_in_column(s->pivot, k))
+			b->style = LABEL_PIVOT;			/* Partition pivot - magenta */
+		else if (SHOW_SORTED_REGION && s->sorted_until >= 0 && i <= s->sorted_until)
+			b->style = LABEL_SORTED;		/* Sorted region - green */
+		else if (HIGHLIGHT_SWAPS && (sample_in_column(last_u, k) || sample_in_column(last_v, k)))
+			b->style = LABEL_SWAPPED;		/* Just swapped - cyan */
+		else if ((owner = sample_owner(s, i)) >= 0)
+			b->style = LABEL_THREAD + owner;	/* Worked on by a thread - its color */
+		else if (s->hi >= 0 && (i < s->lo || i > s->hi))
+			b->style = LABEL_OUTSIDE;		/* Outside the working region - dim */
+		else
+			b->style = LABEL_NORMAL;		/* Normal - gray */
+
+		if (sample_in_column(u, k)) b->mark = MARK_CURRENT; else
+		if (sample_in_column(v, k)) b->mark = MARK_RUNNING; else
+		if (sample_in_column(t, k)) b->mark = MARK_EXTRA; else
+		b->mark = MARK_NONE;
+	}
+
+	/* Update last swap positions */
+	if (u != last_u || v != last_v) {
+		last_u = u;
+		last_v = v;
+	}
+}
+
+/*---- FULL REDRAW -------------------------*/
+void board_stats_line(FRAME * f, SAMPLES * s, int line) {
+	/* right hand statistics panel, one line per board row */
+	int k = (line >= 5) ? stat_at(s, line - 5) : 0;
+	if (!SHOW_STATISTICS || k < 0) return;
+	frame_putc(f, ' ', 1);
+	switch (line) {
+	case 0:
+	case 2: frame_puts(f, VT_COLOR(8) "+-----+"); break;
+	case 1: frame_puts(f, VT_COLOR(8) "|" VT_COLOR(220) "STATS" VT_COLOR(8) "|"); break;
+	case 3: frame_puts(f, VT_COLOR(244) "CMP:" VT_COLOR(39)); frame_num(f, s->comparisons, 0); break;
+	case 4: frame_puts(f, VT_COLOR(244) "SWP:" VT_COLOR(196)); frame_num(f, s->swaps, 0); break;
+	default: frame_puts(f, STAT_LABEL[k]); frame_num(f, stat_value(s, k), 0); break;
+	}
+}
+
+void board_sep_line(FRAME * f) {
+	frame_puts(f, VT_COLOR(8));
+	for (int k = 0; k < BOARD_WIDTH; k++)
+		frame_cell(f, &sepLine);
+}
+
+void board_draw_full(FRAME * f, SAMPLES * s, int rows) {
+	int j, k;
+
+	/* Add sort algorithm title to buffer */
+	frame_puts(f, sortTitle);
+	frame_putc(f, '\n', 1);
+
+	/* Add top horz. line to buffer */
+	board_sep_line(f);
+	board_stats_line(f, s, 0);
+	frame_putc(f, '\n', 1);
+
+	/* Add sort samples to buffer with stats on right */
+	for (j = 0; j < rows; j++) {
+		for (k = 0; k < BOARD_COLS; k++) {
+			frame_putc(f, ' ', 1);
+			frame_cell(f, &barCell[board[k].shade][j < board[k].height ? CELL_SHADE : CELL_BLOCK]);
+			frame_putc(f, ' ', 1);
+		}
+		board_stats_line(f, s, j + 1);
+		frame_putc(f, '\n', 1);
+	}
+
+	/* Add bottom horz. line to buffer */
+	board_sep_line(f);
+	board_stats_line(f, s, rows + 1);
+	frame_putc(f, '\n', 1);
+
+	/* Add sort values to buffer with enhanced highlighting */
+	for (k = 0; k < BOARD_COLS; k++) {
+		frame_puts(f, LABEL_STYLE[board[k].style]);
+		frame_num(f, board[k].label, 3);
+		frame_puts(f, VT_DEFAULTATTR " ");
+	}
+	board_stats_line(f, s, rows + 2);
+	frame_putc(f, '\n', 1);
+
+	/* Add current indices to buffer */
+	frame_puts(f, VT_COLOR(231));
+	for (k = 0; k < BOARD_COLS; k++) {
+		frame_putc(f, ' ', 1);
+		frame_cell(f, &markCell[board[k].mark]);
+		frame_putc(f, ' ', 1);
+	}
+	board_stats_line(f, s, rows + 3);
+	frame_putc(f, '\n', 1);
+}
+
+/*---- DIFFERENTIAL REDRAW -----------------*/
+/* Emits cursor positioning plus the cells that differ from the frame on
+   screen, so a swap costs two columns instead of the whole board. */
+void board_draw_diff(FRAME * f, SAMPLES * s, int rows) {
+	int j, k, from, to;
+
+	for (k = 0; k < BOARD_COLS; k++) {
+		BOARD_COLUMN * b = &board[k], * o = &shown[k];
+
+		/* a new shade recolors the whole bar, a new height only the rows in between */
+		if (b->shade != o->shade) {
+			from = 0; to = rows;
+		} else {
+			from = (b->height < o->height) ? b->height : o->height;
+			to   = (b->height < o->height) ? o->height : b->height;
+		}
+		for (j = from; j < to; j++) {
+			frame_goto(f, BOARD_TOP + j, (k << 2) + 2);
+			frame_cell(f, &barCell[b->shade][j < b->height ? CELL_SHADE : CELL_BLOCK]);
+		}
+
+		if (b->label != o->label || b->style != o->style) {
+			frame_goto(f, BOARD_VALUES(rows), (k << 2) + 1);
+			frame_puts(f, LABEL_STYLE[b->style]);
+			frame_num(f, b->label, 3);
+			frame_puts(f, VT_DEFAULTATTR);
+		}
+
+		if (b->mark != o->mark) {
+			frame_goto(f, BOARD_INDICES(rows), (k << 2) + 2);
+			frame_puts(f, VT_COLOR(231));
+			frame_cell(f, &markCell[b->mark]);
+		}
+	}
+
+	if (SHOW_STATISTICS && s->comparisons != shownCmp) {
+		frame_goto(f, BOARD_STATS(3), BOARD_WIDTH + 2);
+		frame_puts(f, VT_COLOR(244) "CMP:" VT_COLOR(39));
+		frame_num(f, s->comparisons, 0);
+		frame_puts(f, VT_ERASELINE);
+	}
+	if (SHOW_STATISTICS && s->swaps != shownSwp) {
+		frame_goto(f, BOARD_STATS(4), BOARD_WIDTH + 2);
+		frame_puts(f, VT_COLOR(244) "SWP:" VT_COLOR(196));
+		frame_num(f, s->swaps, 0);
+		frame_puts(f, VT_ERASELINE);
+	}
+	bool changed = false;
+	for (int k = 0; k < STAT_COUNT; k++)
+		changed = changed || stat_value(s, k) != shownStat[k];
+	if (SHOW_STATISTICS && changed) {
+		/* a stat turning non-zero shifts the ones below it, down to the
+		   last panel line board_draw_full() has */
+		for (int n = 0; n < STAT_COUNT && 5 + n <= rows + 3; n++) {
+			int k = stat_at(s, n);
+			frame_goto(f, BOARD_STATS(5 + n), BOARD_WIDTH + 2);
+			if (k >= 0) {
+				frame_puts(f, STAT_LABEL[k]);
+				frame_num(f, stat_value(s, k), 0);
+			}
+			frame_puts(f, VT_ERASELINE);
+		}
+	}
+
+	/* park the cursor below the board, where prompts are expected */
+	frame_goto(f, BOARD_INDICES(rows) + 1, 1);
+}
+
+/* Builds the next frame into f and marks it as the frame on screen */
+void board_render(FRAME * f, SAMPLES * s, int u, int v, int t) {
+	int rows = sample_rows(s);
+
+	cells_prepare();
+	board_build(s, u, v, t);
+	f->len = 0;
+	if (DIFF_RENDERING && boardShown && rows == shownRows)
+		board_draw_diff(f, s, rows);
+	else
+		board_draw_full(f, s, rows);
+
+	memcpy(shown, board, sizeof(board));
+	shownRows = rows;
+	shownCmp = s->comparisons;
+	shownSwp = s->swaps;
+	for (int k = 0; k < STAT_COUNT; k++)
+		shownStat[k] = stat_value(s, k);
+	boardShown = true;
+}
+
+void sample_show(SAMPLES * s, int u, int v, int t){
+	/* skip visualization if disabled */
+	if (!ENABLE_VISUALIZATION) return;
+
+	board_render(&screen, s, u, v, t);
+
+	/* Write entire screen at once (atomic operation) */
+	fwrite(screen.buf, 1, screen.len, stdout);
+	fflush(stdout);
+
+	reset_colors();
+}
+
+#endif
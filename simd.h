@@ -0,0 +1,276 @@
+#ifndef __SORTVIS_SIMD__
+#define __SORTVIS_SIMD__
+
+/*---- SORTING NETWORK KERNELS -------------*/
+/* Bitonic networks for blocks of 8, 16 and 32 ints and a merge of two
+   sorted runs built on the same networks. Every comparator is a min and a
+   max, so a kernel costs the same whatever the data. The vector versions
+   are compiled with target attributes and picked at runtime from CPUID;
+   the scalar one runs everywhere. */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#define	NET_X86
+	#include <immintrin.h>
+	#include <x86intrin.h>
+	#define	NET_TARGET(isa)	__attribute__((target(isa)))
+#endif
+
+#define	NET_BLOCK_MAX	32				/* largest block a kernel sorts */
+
+typedef struct net_kernel {
+	const char *name;
+	void	(*sort)(int * a, int n);	/* n is 8, 16 or 32 */
+	void	(*merge)(const int * a, int na, const int * b, int nb, int * out);
+} NET_KERNEL;
+
+/* comparators of a bitonic sort of n = 2^p elements: n/2 * p(p+1)/2 */
+long net_comparators(int n) {
+	int p = 0;
+	while ((1 << p) < n) p++;
+	return (long)(n >> 1) * p * (p + 1) / 2;
+}
+
+/*---- scalar ----*/
+static void net_sort_scalar(int * a, int n) {
+	for (int k = 2; k <= n; k <<= 1)
+		for (int j = k >> 1; j > 0; j >>= 1)
+			for (int i = 0; i < n; i++) {
+				int l = i ^ j;
+				if (l < i) continue;
+				int x = a[i], y = a[l];
+				int lo = x < y ? x : y, hi = x < y ? y : x;
+				bool up = !(i & k);
+				a[i] = up ? lo : hi;
+				a[l] = up ? hi : lo;
+			}
+}
+
+static void net_merge_scalar(const int * a, int na, const int * b, int nb, int * out) {
+	int i = 0, j = 0, k = 0;
+	while (i < na && j < nb) out[k++] = (a[i] <= b[j]) ? a[i++] : b[j++];
+	while (i < na) out[k++] = a[i++];
+	while (j < nb) out[k++] = b[j++];
+}
+
+/* Finishes a vector merge: the held vector plus what is left of a and b */
+static void net_merge_tail(const int * held, int nh, const int * a, int na,
+						   const int * b, int nb, int * out) {
+	int tmp[2 * NET_BLOCK_MAX + 64], * t = tmp;
+	if (na + nh > (int)(sizeof(tmp) / sizeof(tmp[0]))) {
+		/* the rest of a does not fit the stack buffer */
+		t = (int *) malloc((size_t)(na + nh) * sizeof(int));
+		if (!t) die(1, "Error: Out of memory for network merge\n");
+	}
+	net_merge_scalar(held, nh, a, na, t);
+	net_merge_scalar(t, nh + na, b, nb, out);
+	if (t != tmp) free(t);
+}
+
+#ifdef NET_X86
+/*---- SSE4.1, four lanes ----*/
+NET_TARGET("sse4.1")
+static __m128i net_swap_sse(__m128i v, int j) {
+	return (j == 1) ? _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1))
+					: _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+NET_TARGET("sse4.1")
+static void net_sort_sse(int * a, int n) {
+	__m128i v[8];
+	const __m128i lane = _mm_setr_epi32(0, 1, 2, 3), zero = _mm_setzero_si128();
+	int q, vn = n >> 2;
+	for (q = 0; q < vn; q++) v[q] = _mm_loadu_si128((const __m128i *)(a + (q << 2)));
+	for (int k = 2; k <= n; k <<= 1)
+		for (int j = k >> 1; j > 0; j >>= 1) {
+			if (j >= 4) {
+				/* whole registers against each other */
+				for (q = 0; q < vn; q++) {
+					int p = q ^ (j >> 2);
+					if (p < q) continue;
+					__m128i lo = _mm_min_epi32(v[q], v[p]), hi = _mm_max_epi32(v[q], v[p]);
+					bool up = !((q << 2) & k);
+					v[q] = up ? lo : hi;
+					v[p] = up ? hi : lo;
+				}
+				continue;
+			}
+			for (q = 0; q < vn; q++) {
+				__m128i w = net_swap_sse(v[q], j);
+				__m128i lo = _mm_min_epi32(v[q], w), hi = _mm_max_epi32(v[q], w);
+				__m128i idx = _mm_add_epi32(lane, _mm_set1_epi32(q << 2));
+				__m128i low = _mm_cmpeq_epi32(_mm_and_si128(idx, _mm_set1_epi32(j)), zero);
+				__m128i up  = _mm_cmpeq_epi32(_mm_and_si128(idx, _mm_set1_epi32(k)), zero);
+				/* a lane keeps the min when it is the low end of an ascending pair or vice versa */
+				v[q] = _mm_blendv_epi8(hi, lo, _mm_cmpeq_epi32(low, up));
+			}
+		}
+	for (q = 0; q < vn; q++) _mm_storeu_si128((__m128i *)(a + (q << 2)), v[q]);
+}
+
+NET_TARGET("sse4.1")
+static void net_merge8_sse(__m128i * x, __m128i * y) {
+	/* x, y sorted: afterwards x holds the four smallest, both sorted */
+	__m128i r = _mm_shuffle_epi32(*y, _MM_SHUFFLE(0, 1, 2, 3));
+	__m128i lo = _mm_min_epi32(*x, r), hi = _mm_max_epi32(*x, r);
+	for (int h = 0; h < 2; h++) {
+		__m128i * v = h ? &hi : &lo;
+		for (int j = 2; j > 0; j >>= 1) {
+			__m128i w = net_swap_sse(*v, j);
+			__m128i mn = _mm_min_epi32(*v, w), mx = _mm_max_epi32(*v, w);
+			*v = (j == 2) ? _mm_blend_epi16(mn, mx, 0xF0) : _mm_blend_epi16(mn, mx, 0xCC);
+		}
+	}
+	*x = lo;
+	*y = hi;
+}
+
+NET_TARGET("sse4.1")
+static void net_merge_sse(const int * a, int na, const int * b, int nb, int * out) {
+	if (na < 4 || nb < 4) { net_merge_scalar(a, na, b, nb, out); return; }
+	__m128i x = _mm_loadu_si128((const __m128i *) a), y = _mm_loadu_si128((const __m128i *) b);
+	int i = 4, j = 4, k = 0, held[4];
+	for (;;) {
+		net_merge8_sse(&x, &y);
+		_mm_storeu_si128((__m128i *)(out + k), x);
+		k += 4;
+		/* refill from the run with the smaller head, the tail takes over when it runs short */
+		bool fromA = j >= nb || (i < na && a[i] <= b[j]);
+		if (fromA && i + 4 <= na) { x = _mm_loadu_si128((const __m128i *)(a + i)); i += 4; }
+		else if (!fromA && j + 4 <= nb) { x = _mm_loadu_si128((const __m128i *)(b + j)); j += 4; }
+		else break;
+	}
+	_mm_storeu_si128((__m128i *) held, y);
+	net_merge_tail(held, 4, a + i, na - i, b + j, nb - j, out + k);
+}
+
+/*---- AVX2, eight lanes ----*/
+NET_TARGET("avx2")
+static void net_sort_avx2(int * a, int n) {
+	__m256i v[4];
+	const __m256i lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), zero = _mm256_setzero_si256();
+	int q, vn = n >> 3;
+	for (q = 0; q < vn; q++) v[q] = _mm256_loadu_si256((const __m256i *)(a + (q << 3)));
+	for (int k = 2; k <= n; k <<= 1)
+		for (int j = k >> 1; j > 0; j >>= 1) {
+			if (j >= 8) {
+				for (q = 0; q < vn; q++) {
+					int p = q ^ (j >> 3);
+					if (p < q) continue;
+					__m256i lo = _mm256_min_epi32(v[q], v[p]), hi = _mm256_max_epi32(v[q], v[p]);
+					bool up = !((q << 3) & k);
+					v[q] = up ? lo : hi;
+					v[p] = up ? hi : lo;
+				}
+				continue;
+			}
+			__m256i perm = _mm256_xor_si256(lane, _mm256_set1_epi32(j));
+			for (q = 0; q < vn; q++) {
+				__m256i w = _mm256_permutevar8x32_epi32(v[q], perm);
+				__m256i lo = _mm256_min_epi32(v[q], w), hi = _mm256_max_epi32(v[q], w);
+				__m256i idx = _mm256_add_epi32(lane, _mm256_set1_epi32(q << 3));
+				__m256i low = _mm256_cmpeq_epi32(_mm256_and_si256(idx, _mm256_set1_epi32(j)), zero);
+				__m256i up  = _mm256_cmpeq_epi32(_mm256_and_si256(idx, _mm256_set1_epi32(k)), zero);
+				v[q] = _mm256_blendv_epi8(hi, lo, _mm256_cmpeq_epi32(low, up));
+			}
+		}
+	for (q = 0; q < vn; q++) _mm256_storeu_si256((__m256i *)(a + (q << 3)), v[q]);
+}
+
+NET_TARGET("avx2")
+static __m256i net_clean8_avx2(__m256i v) {
+	/* bitonic v to ascending: half cleaners at distance 4, 2 and 1 */
+	__m256i w = _mm256_permute2x128_si256(v, v, 0x01);
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), 0xF0);
+	w = _mm256_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+	v = _mm256_blend_epi32(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), 0xCC);
+	w = _mm256_shuffle_epi32(v, _MM_SHUFFLE(2, 3, 0, 1));
+	return _mm256_blend_epi32(_mm256_min_epi32(v, w), _mm256_max_epi32(v, w), 0xAA);
+}
+
+NET_TARGET("avx2")
+static void net_merge16_avx2(__m256i * x, __m256i * y) {
+	/* x, y sorted: afterwards x holds the eight smallest, both sorted */
+	__m256i r = _mm256_permutevar8x32_epi32(*y, _mm256_setr_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+	__m256i lo = _mm256_min_epi32(*x, r), hi = _mm256_max_epi32(*x, r);
+	*x = net_clean8_avx2(lo);
+	*y = net_clean8_avx2(hi);
+}
+
+NET_TARGET("avx2")
+static void net_merge_avx2(const int * a, int na, const int * b, int nb, int * out) {
+	if (na < 8 || nb < 8) { net_merge_scalar(a, na, b, nb, out); return; }
+	__m256i x = _mm256_loadu_si256((const __m256i *) a), y = _mm256_loadu_si256((const __m256i *) b);
+	int i = 8, j = 8, k = 0, held[8];
+	for (;;) {
+		net_merge16_avx2(&x, &y);
+		_mm256_storeu_si256((__m256i *)(out + k), x);
+		k += 8;
+		/* refill from the run with the smaller head, the tail takes over when it runs short */
+		bool fromA = j >= nb || (i < na && a[i] <= b[j]);
+		if (fromA && i + 8 <= na) { x = _mm256_loadu_si256((const __m256i *)(a + i)); i += 8; }
+		else if (!fromA && j + 8 <= nb) { x = _mm256_loadu_si256((const __m256i *)(b + j)); j += 8; }
+		else break;
+	}
+	_mm256_storeu_si256((__m256i *) held, y);
+	net_merge_tail(held, 8, a + i, na - i, b + j, nb - j, out + k);
+}
+#endif
+
+const NET_KERNEL NET_KERNELS[] = {
+	{ "scalar", net_sort_scalar, net_merge_scalar },
+#ifdef NET_X86
+	{ "sse4.1", net_sort_sse,    net_merge_sse    },
+	{ "avx2",   net_sort_avx2,   net_merge_avx2   },
+#endif
+};
+#define	NET_KERNEL_COUNT	(int)(sizeof(NET_KERNELS) / sizeof(NET_KERNELS[0]))
+
+const char *		SIMD_CHOICE = NULL;	/* --simd: kernel name, "off" or NULL for the best */
+bool				NET_BASE = true;	/* quick and merge sort small ranges with a kernel */
+static const NET_KERNEL * net = NULL;
+
+bool net_supported(const NET_KERNEL * k) {
+#ifdef NET_X86
+	__builtin_cpu_init();
+	if (strcmp(k->name, "avx2") == 0)   return __builtin_cpu_supports("avx2");
+	if (strcmp(k->name, "sse4.1") == 0) return __builtin_cpu_supports("sse4.1");
+#endif
+	return strcmp(k->name, "scalar") == 0;
+}
+
+/* Picks the kernel once: the one named by --simd, else the widest the cpu
+   runs. Returns false for an unknown or unsupported name. */
+bool net_select() {
+	net = &NET_KERNELS[0];
+	if (SIMD_CHOICE && strcmp(SIMD_CHOICE, "off") == 0) {
+		NET_BASE = false;
+		return true;
+	}
+	for (int k = 0; k < NET_KERNEL_COUNT; k++) {
+		if (SIMD_CHOICE ? strcmp(SIMD_CHOICE, NET_KERNELS[k].name) != 0 : !net_supported(&NET_KERNELS[k]))
+			continue;
+		if (SIMD_CHOICE && !net_supported(&NET_KERNELS[k])) return false;
+		net = &NET_KERNELS[k];
+		if (SIMD_CHOICE) return true;
+	}
+	return SIMD_CHOICE == NULL;
+}
+
+const NET_KERNEL * net_kernel() {
+	if (!net) net_select();
+	return net;
+}
+
+/* Sorts up to NET_BLOCK_MAX ints, padding to the next kernel size with
+   INT_MAX. Returns the comparators spent. */
+long net_sort_small(int * a, int n) {
+	int block[NET_BLOCK_MAX], size = 8, i;
+	while (size < n) size <<= 1;
+	for (i = 0; i < n; i++) block[i] = a[i];
+	for (; i < size; i++) block[i] = 0x7FFFFFFF;
+	net_kernel()->sort(block, size);
+	for (i = 0; i < n; i++) a[i] = block[i];
+	return net_comparators(size);
+}
+
+#endif
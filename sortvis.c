@@ -7,7 +7,7 @@
  *	MIT licensed
  *
  *	Compile: 
- *		gcc -O2 sortvis.c -o sortvis
+ *		gcc -O2 -pthread sortvis.c -o sortvis
  *	or:
  *		make
  *	or:
@@ -43,6 +43,50 @@
  *  - Fixed Win32 arrow key detection compatibility
  *  - Added robust terminal initialization with error messages
  *  - Added Circle Sort visualization
+ *  - Headless benchmark mode (--bench) with wall-clock timings
+ *  - Sample size selectable at runtime (--size), samples are heap allocated
+ *  - Differential rendering: only changed board cells are redrawn
+ *  - Frames are built with pre-encoded cells in a growable buffer
+ *  - Algorithms emit operation events, the animation replays them
+ *  - Sort runs can be recorded to compact trace files (--record, --replay)
+ *  - Large samples sort on a worker thread, sampled at a fixed frame rate (--fps)
+ *  - Animations can be fitted into a fixed wall time (--duration)
+ *  - Parallel merge sort on a thread pool with merge path splits (--threads)
+ *  - Main menu is built from the algorithm registry
+ *  - Parallel quick sort on work-stealing deques, with a live steal counter
+ *  - Sorting network kernels (scalar, SSE4.1, AVX2) picked at runtime, used as
+ *    Network Sort and as the small-range base case of quick and merge sort
+ *  - Radix Sort uses 8-bit digits, one histogram pass and skips trivial passes
+ *  - Quick Sort is pattern-defeating, the stats panel shows its recursion depth
+ *  - Added Tim Sort: natural runs, galloping merges, merge stack drawn in colors
+ *  - Merge Sort is bottom-up over a reused scratch arena, scratch memory and
+ *    bytes moved are shown with the stats and in the --bench table
+ *  - Added D-ary Heap Sort: iterative, bottom-up sift-down, arity 2, 4 or 8,
+ *    tree levels drawn in colors, --bench-heap compares it with Heap Sort
+ *  - Counting Sort takes any key range, counts and scatters on every thread
+ *    and hands ranges too wide for its histograms to Radix Sort
+ *  - Samples come from a seeded xoshiro256** generator (--seed), shuffled
+ *    uniformly on every thread; new layouts: few unique, sawtooth, organ
+ *    pipe, nearly sorted (--perturb), zipf and all equal, picked with --dist
+ *    or from the generate menu
+ *  - Record sorts generated per key width and record size, whole or through
+ *    (key, index) pairs; --bench-records shows where indirect sorting wins
+ *  - Hardware counters per sort through perf_event_open (--perf), shown in
+ *    the --bench table and the stats panel
+ *  - Reads, writes, strides and reuse distances of every sort traced from
+ *    its events (--locality)
+ *  - Set associative LRU cache model fed by the sorts (--cache), hits and
+ *    misses counted live, bars colored by the level that served them
+ *  - Added Block Quick Sort: branchless BlockQuicksort partition into offset
+ *    buffers, --bench-block compares its time and branch misses
+ *  - Repeated --bench runs with warmup, median, p10/p90 and MAD (--repeat,
+ *    --warmup), csv and json tables (--format), cpu pinning (--pin) and
+ *    Mann-Whitney regression checks against a json baseline (--compare),
+ *    make bench replaces the stale test target
+ *  - Complexity sweep (--bench-sweep, --sweep): time, comparisons and
+ *    swaps over a geometric range of sizes fitted to n, n log n and n^2,
+ *    with the crossovers between the fitted times and the quick sort
+ *    insertion cutoffs
  */
 
 #include "sortvis.h"
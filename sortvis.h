@@ -9,6 +9,11 @@
 #ifndef __SORTVIS_H__
 #define	__SORTVIS_H__
 
+#ifndef _WIN32					/* POSIX clocks and nanosleep() under -std=c99 */
+#	define	_DEFAULT_SOURCE
+#	define	_DARWIN_C_SOURCE
+#endif
+
 #include <stdio.h>
 #include <time.h>
 #include <stdlib.h>
@@ -35,8 +40,13 @@
 #endif
 
 /*---- SORT SAMPLES DATA--------------------*/
-#define	SAMPLE_SIZE		18
-#define	BOARD_WIDTH		(SAMPLE_SIZE << 2)
+#define	SAMPLE_SIZE_MIN	18
+#define	SAMPLE_SIZE_MAX	(1 << 29)	/* origin, sort and scratch already take 6 GB */
+#define	VIEW_MAX_COLS	32			/* larger samples are drawn by sampling columns */
+#define	VIEW_MAX_ROWS	20			/* and by scaling bar heights */
+#define	BOARD_COLS		(SAMPLE_SIZE < VIEW_MAX_COLS ? SAMPLE_SIZE : VIEW_MAX_COLS)
+#define	BOARD_WIDTH		(BOARD_COLS << 2)
+int SAMPLE_SIZE = SAMPLE_SIZE_MIN;	/* number of samples, set with --size */
 int SAMPLE_SPEED = 60;		/* animation speed (in milliseconds) */
 
 #ifndef bool
@@ -52,16 +62,33 @@ bool SHOW_SORTED_REGION = true;		/* highlight sorted portions */
 bool SMOOTH_TRANSITIONS = true;		/* animate element movements with intermediate frames */
 int TRANSITION_FRAMES = 3;			/* number of intermediate frames for smooth transitions */
 bool PROGRESSIVE_COLORS = false;	/* use color gradients based on comparison intensity (disabled) */
+bool USE_HUGE_PAGES = true;			/* back large sample arrays with transparent huge pages */
+
+#define	REGION_COUNT	8	/* threads with their own color on the board */
+#define	HW_COUNTERS		6	/* hardware counters, see perf.h */
+#define	LOC_COUNTERS	11	/* access counts, see locality.h */
+#define	CACHE_COUNTERS	6	/* modelled hits and misses per level, see cache.h */
 
 typedef struct samples {
-	int data[SAMPLE_SIZE];
+	int *data;				/* SAMPLE_SIZE values, see sample_alloc() */
 	int max;
 	long comparisons;		/* number of comparisons made */
 	long swaps;				/* number of swaps made */
+	long steals;			/* tasks taken over by another thread */
+	int depth;				/* deepest recursion reached, 0 when not tracked */
+	long aux;				/* peak scratch memory in bytes */
+	long moved;				/* bytes copied between samples and scratch memory */
 	int sorted_until;		/* index where array is sorted (for optimization tracking) */
+	int pivot;				/* pivot index being partitioned around, -1 for none */
+	int lo, hi;				/* region being worked on, -1 for none */
+	struct { int lo, hi; } region[REGION_COUNT];	/* per thread regions, -1 for none */
+	long hw[HW_COUNTERS];	/* hardware counters of a measured run, -1 for none */
+	long loc[LOC_COUNTERS];	/* reads, writes and their locality, 0 until traced */
+	long cache[CACHE_COUNTERS];	/* modelled hits and misses, 0 without --cache */
 } SAMPLES;
 
-typedef	char SHADES[SAMPLE_SIZE][16];
+#define	SHADE_COUNT		18
+typedef	char SHADES[SHADE_COUNT][16];
 
 /* characters for rendering samples on screen */
 #ifdef _WIN32
@@ -196,6 +223,7 @@ const SHADES SHADE_VIRIDIS =
 
 /* global variables */
 static char		sortTitle[256] = {0};		/* for displaying sort algorithm title */
+static bool		boardShown = false;			/* board is on screen and can be updated in place */
 static char		menuText[1600] = {0};		/* for setting up main menu */
 static SHADES	colors = {0};				/* for selecting shades for sample rendering */
 static char		menuTitle[1024];
@@ -205,6 +233,7 @@ static char 	menuFooter[64];
 void set_shades(const SHADES shade) { memcpy(colors, shade, sizeof(SHADES)); }
 
 void title(const char * name) {
+	boardShown = false;		/* a new title means a freshly cleared screen */
 	sprintf(sortTitle,	"%s%*s%s<%s<%s<%s< %s%s %s>%s>%s>%s>", 
 						VT_CURSORHOME,
 						(int)(BOARD_WIDTH-strlen(name)-10)>>1,"",
@@ -213,7 +242,20 @@ void title(const char * name) {
 						VT_COLOR(250), VT_COLOR(247), VT_COLOR(244), VT_COLOR(241));
 }
 
+#include "events.h"
+#include "pool.h"
+#include "simd.h"
 #include "algs.h"
+#include "gen.h"
+#include "records.h"
+#include "locality.h"
+#include "cache.h"
+#include "render.h"
+#include "perf.h"
+#include "player.h"
+#include "live.h"
+#include "bench.h"
+#include "trace.h"
 
 void app_init() {
 
@@ -226,7 +268,6 @@ void app_init() {
 	}
 
 	cursor_hide();
-	srand(time(NULL));
 	set_shades(SHADE_RAINBOW);
 	
 	sprintf(menuTitle, 
@@ -313,43 +354,51 @@ void app_menu() {
 	fputs(menuText, stdout);	
 }
 
-void app_menu_arrow(int selected) {
-	const char* items[] = {
-		"A. Interchange Sort",
-		"B. Bubble Sort",
-		"C. Cocktail Sort",
-		"D. Selection Sort",
-		"E. Insertion Sort",
-		"F. Shell Sort",
-		"G. Comb Sort",
-		"H. Merge Sort",
-		"I. Heap Sort",
-		"J. Counting Sort",
-		"K. Quick Sort",
-		"L. Radix Sort",
-		"M. Circle Sort",
-		"",
-		"N. View Samples",
-		"O. Generate New",
-		"P. Select Gradient",
-		"",
-		"Q. Exit"
+/* Main menu rows, the algorithms from the registry then the commands.
+   Rows with a key of 0 are separators. */
+typedef struct menu_item {
+	char		key;
+	const char *text;
+} MENU_ITEM;
+
+static MENU_ITEM	menuItems[ALGORITHM_COUNT + 6];
+static int			menuCount = 0;
+
+void app_menu_build() {
+	const MENU_ITEM commands[] = {
+		{ 0,   ""                },
+		{ 'N', "View Samples"    },
+		{ 'O', "Generate New"    },
+		{ 'P', "Select Gradient" },
+		{ 0,   ""                },
+		{ 'Q', "Exit"            },
 	};
-	
+	menuCount = 0;
+	for (int a = 0; a < ALGORITHM_COUNT; a++) {
+		menuItems[menuCount].key = ALGORITHMS[a].key;
+		menuItems[menuCount++].text = ALGORITHMS[a].label;
+	}
+	for (int c = 0; c < (int)(sizeof(commands) / sizeof(commands[0])); c++)
+		menuItems[menuCount++] = commands[c];
+}
+
+void app_menu_arrow(int selected) {
+	char item[32];
 	printf("%s", menuTitle);
-	for (int i = 0; i < 19; i++) {
-		if (items[i][0] == '\0') {
+	for (int i = 0; i < menuCount; i++) {
+		if (menuItems[i].key == 0) {
 			printf("%so----------------------o\n", VT_COLOR(8));
 		} else {
+			snprintf(item, sizeof(item), "%c. %s", menuItems[i].key, menuItems[i].text);
 			if (i == selected) {
-				printf("%s| %s%-20s %s|%s\n", VT_COLOR(8), VT_ATTR(7), items[i], VT_COLOR(8), VT_DEFAULTATTR);
+				printf("%s| %s%-20s %s|%s\n", VT_COLOR(8), VT_ATTR(7), item, VT_COLOR(8), VT_DEFAULTATTR);
 			} else {
-				printf("%s| %s%-20s %s|%s\n", VT_COLOR(8), VT_COLOR(153), items[i], VT_COLOR(8), VT_DEFAULTATTR);
+				printf("%s| %s%-20s %s|%s\n", VT_COLOR(8), VT_COLOR(153), item, VT_COLOR(8), VT_DEFAULTATTR);
 			}
 		}
 	}
 	printf("%so----------------------o\n", VT_COLOR(8));
-	printf("%sUse %sUP/DOWN%s arrows or %sA-Q%s, press %sENTER%s to select\n",
+	printf("%sUse %sUP/DOWN%s arrows or %sletter keys%s, press %sENTER%s to select\n",
 		   VT_DEFAULTATTR, VT_ATTR(33), VT_DEFAULTATTR,
 		   VT_ATTR(33), VT_DEFAULTATTR,
 		   VT_ATTR(33), VT_DEFAULTATTR);
@@ -367,6 +416,44 @@ void app_version() {
 	die(0, buffer);
 }
 
+#define	MENU_COMMAND_KEYS	"NOPQX"		/* menu letters that are not algorithms, X exits too */
+
+/* Prints the letters in keys as ranges, e.g. "A-M, R-W" */
+static void help_key_ranges(const char * keys) {
+	bool used[26] = { false };
+	for (const char * p = keys; *p; p++) used[*p - 'A'] = true;
+	for (int k = 0, first = 1; k < 26; k++) {
+		if (!used[k] || (k > 0 && used[k - 1])) continue;
+		int last = k;
+		while (last + 1 < 26 && used[last + 1]) last++;
+		printf(first ? "%c" : ", %c", 'A' + k);
+		if (last > k) printf("-%c", 'A' + last);
+		first = 0;
+	}
+}
+
+/* Lists the registry labels without their " Sort", wrapped like the help */
+static void help_algorithms() {
+	int width = 2;
+	printf("  ");
+	for (int a = 0; a < ALGORITHM_COUNT; a++) {
+		const char * label = ALGORITHMS[a].label;
+		int len = (int) strlen(label);
+		if (len > 5 && strcmp(label + len - 5, " Sort") == 0) len -= 5;
+		if (a > 0 && width + len + 2 > 64) {
+			printf(",\n  ");
+			width = 2;
+		}
+		else if (a > 0) {
+			printf(", ");
+			width += 2;
+		}
+		printf("%.*s", len, label);
+		width += len;
+	}
+	printf("\n\n");
+}
+
 void app_help() {
 	printf("SortVis - Sort Algorithm Visualizations\n");
 	printf("========================================\n\n");
@@ -377,16 +464,103 @@ void app_help() {
 	printf("  -h, --help           Display this help message\n");
 	printf("  -s, --speed <value>  Set animation speed in milliseconds (default: 60)\n");
 	printf("                       Lower values = faster animation\n");
-	printf("                       Recommended range: 10-200\n\n");
+	printf("                       Recommended range: 10-200\n");
+	printf("  -b, --bench          Run every algorithm without visualization and\n");
+	printf("                       print a timing table (tab separated) to stdout\n");
+	printf("  -n, --size <value>   Number of samples, 18 up to 536870912 (default: 18)\n");
+	printf("                       Accepts scientific notation, e.g. 1e6\n");
+	printf("      --algs <list>    Comma separated algorithms to benchmark,\n");
+	printf("                       e.g. merge,heap,quick (default: all)\n");
+	printf("      --dist <list>    Comma separated sample layouts to benchmark: random,\n");
+	printf("                       ascending, descending, few, sawtooth, organ, nearly,\n");
+	printf("                       zipf, equal (default: all); the first one is also\n");
+	printf("                       the layout of the starting and recorded samples\n");
+	printf("      --seed <value>   Seed of the random samples, for reproducible runs\n");
+	printf("                       (default: the clock, printed by --bench)\n");
+	printf("      --repeat <n>     Timed runs of each --bench sort, on a fresh copy\n");
+	printf("                       of the same samples; the table gives the median,\n");
+	printf("                       p10, p90 and median absolute deviation (default: 1)\n");
+	printf("      --warmup <n>     Untimed runs before them (default: 1 when repeating)\n");
+	printf("      --format <f>     --bench table format: tsv, csv or json (default: tsv)\n");
+	printf("      --compare <file> Check the --bench times against a --format json\n");
+	printf("                       table with a Mann-Whitney U test, exits with 1 on\n");
+	printf("                       significant regressions\n");
+	printf("      --pin <cpus>     Run on these cpus only, e.g. 2 or 0,2-3\n");
+	printf("      --perturb <k>    Percent of nearly sorted samples moved (default: 5)\n");
+	printf("      --no-huge-pages  Do not advise huge pages for large samples\n");
+	printf("      --full-redraw    Redraw the whole board every frame instead of\n");
+	printf("                       only the cells that changed\n");
+	printf("      --bench-render   Measure frames per second of both renderers\n");
+	printf("                       for the current --size, without drawing\n");
+	printf("      --duration <t>   Fit every animation into this wall time, e.g. 20s,\n");
+	printf("                       1.5m or 800ms, drawing at most 60 frames per second\n");
+	printf("  -t, --threads <n>    Threads used by the parallel sorts (default: all cpus)\n");
+	printf("      --bench-threads  Time the parallel sorts with 1 up to --threads\n");
+	printf("                       threads against their serial versions\n");
+	printf("      --simd <kernel>  Sorting network kernel: scalar, sse4.1, avx2, or\n");
+	printf("                       off to keep quick and merge sort without it\n");
+	printf("                       (default: the widest the cpu supports)\n");
+	printf("      --bench-simd     Print cycles per element of every network kernel\n");
+	printf("      --heap-arity <d> Children per node of the d-ary heap sort: 2, 4\n");
+	printf("                       or 8 (default: 4)\n");
+	printf("      --bench-heap     Time heap sort against the d-ary heap sort of\n");
+	printf("                       every arity on random samples of each --sizes\n");
+	printf("                       entry\n");
+	printf("      --bench-records  Time sorting whole records of 16 to 128 bytes\n");
+	printf("                       against sorting (key, index) pairs and permuting\n");
+	printf("                       the records\n");
+	printf("      --bench-block    Time quick sort against block quick sort on random\n");
+	printf("                       and few unique samples, with their branch misses\n");
+	printf("      --bench-radix    Radix sort 32 and 64-bit unsigned, signed and\n");
+	printf("                       floating point keys and check their order\n");
+	printf("      --bench-sweep    Time every algorithm on sizes from 2^5 to 2^22,\n");
+	printf("                       fit time, comparisons and swaps to n, n log n and\n");
+	printf("                       n^2, print where the fitted times cross and time\n");
+	printf("                       quick sort's insertion sort cutoffs\n");
+	printf("      --sweep <lo-hi>  Powers of two the sweep runs between, 5 to 29\n");
+	printf("      --perf           Count cycles, instructions, branch misses and L1D,\n");
+	printf("                       LLC and dTLB misses of each sort with Linux perf\n");
+	printf("                       events, worker threads included, as --bench\n");
+	printf("                       columns and in the stats panel\n");
+	printf("      --locality       Count the reads and writes of each sort in the\n");
+	printf("                       samples and scratch memory, binned by stride and\n");
+	printf("                       by reuse distance in cache lines, as --bench\n");
+	printf("                       columns and in the stats panel\n");
+	printf("      --cache          Feed the samples and scratch memory each sort\n");
+	printf("                       touches to a model of set associative LRU caches,\n");
+	printf("                       hits and misses per level are --bench columns and\n");
+	printf("                       are counted live in the stats panel, bar colors\n");
+	printf("                       show the level the last access of each column\n");
+	printf("                       came from; both trace the animated sorts\n");
+	printf("      --cache-levels <list>  Size and ways of each modelled level, L1 first\n");
+	printf("                       (default: 32K/8,1M/16,32M/16)\n");
+	printf("      --cache-line <b> Modelled line size in bytes (default: 64)\n");
+	printf("      --sizes <list>   Comma separated sample counts for --bench-heap\n");
+	printf("                       (default: 1e5,1e6,1e7,1e8), --bench-records\n");
+	printf("                       (default: 1e6), --bench-block and --bench-radix\n");
+	printf("                       (default: 1e7)\n");
+	printf("      --fps <value>    Sort on a worker thread and draw this many frames\n");
+	printf("                       per second of its current state, 0 animates\n");
+	printf("                       every operation (default: 30 above 32 samples)\n");
+	printf("      --record <file>  Sort the first --dist samples with the first --algs\n");
+	printf("                       entry and save every operation to a trace file\n");
+	printf("      --replay <file>  Animate a trace file without running the sort\n\n");
 	printf("EXAMPLES:\n");
 	printf("  sortvis              Run with default settings\n");
 	printf("  sortvis -s 100       Run with slower animation (100ms delay)\n");
-	printf("  sortvis --speed 30   Run with faster animation (30ms delay)\n\n");
+	printf("  sortvis --speed 30   Run with faster animation (30ms delay)\n");
+	printf("  sortvis --bench      Measure all algorithms on all sample layouts\n\n");
 	printf("SUPPORTED ALGORITHMS:\n");
-	printf("  Interchange, Bubble, Cocktail, Selection, Insertion, Shell,\n");
-	printf("  Comb, Merge, Heap, Counting, Quick, Radix\n\n");
+	help_algorithms();
 	printf("NAVIGATION:\n");
-	printf("  Use UP/DOWN arrow keys or letter keys (A-Q) to navigate menus\n");
+	char keys[ALGORITHM_COUNT + 1];
+	for (int a = 0; a < ALGORITHM_COUNT; a++) keys[a] = ALGORITHMS[a].key;
+	keys[ALGORITHM_COUNT] = '\0';
+	printf("  Use UP/DOWN arrow keys or letter keys to navigate menus:\n  ");
+	help_key_ranges(keys);
+	printf(" pick an algorithm and ");
+	help_key_ranges(MENU_COMMAND_KEYS);
+	printf(" a command\n");
 	printf("  Press ENTER to select an option\n\n");
 	printf("REQUIREMENTS:\n");
 	printf("  Windows 10 or later (for color support)\n");
@@ -401,7 +575,12 @@ void app_exec() {
 	int selected = 0;
 	int useArrows = 1;  /* Use arrow key navigation by default */
 	
-	sample_generate_random(&origin); 
+	if (!sample_alloc(&origin) || !sample_alloc(&sort)) {
+		fprintf(stderr, "Error: Cannot allocate %d samples\n", SAMPLE_SIZE);
+		return;
+	}
+	sample_generate_first(&origin);
+	app_menu_build();
 	
 	while (!done) {
 				
@@ -415,18 +594,16 @@ void app_exec() {
 			/* Handle arrow keys */
 			if (ch == 'U') {  /* Up arrow */
 				do {
-					selected = (selected - 1 + 19) % 19;
-				} while (selected == 13 || selected == 17);  /* Skip empty lines */
+					selected = (selected - 1 + menuCount) % menuCount;
+				} while (menuItems[selected].key == 0);  /* Skip empty lines */
 				continue;
 			} else if (ch == 'D') {  /* Down arrow */
 				do {
-					selected = (selected + 1) % 19;
-				} while (selected == 13 || selected == 17);  /* Skip empty lines */
+					selected = (selected + 1) % menuCount;
+				} while (menuItems[selected].key == 0);  /* Skip empty lines */
 				continue;
 			} else if (ch == '\n' || ch == '\r') {  /* Enter key */
-				/* Map selected index to choice letter */
-				const char mapping[] = "ABCDEFGHIJKLM NOP Q";
-				choice = mapping[selected];
+				choice = menuItems[selected].key;
 			} else if (ch >= 'a' && ch <= 'z') {
 				choice = toupper(ch);
 			} else if (ch >= 'A' && ch <= 'Z') {
@@ -440,24 +617,12 @@ void app_exec() {
 			choice = toupper(choice & 0xFF);
 		}
 		
-		if (choice < 'A' || choice > 'Q') continue;
+		if (!choice || (!algorithm_by_key(choice) && !strchr(MENU_COMMAND_KEYS, choice))) continue;
 				
 		clear();
 
 		switch(choice) {
-		case 'A' : 	sort = origin; sample_sort_interchange(&sort);                    break;
-		case 'B' : 	sort = origin; sample_sort_bubble     (&sort);                    break;
-		case 'C' : 	sort = origin; sample_sort_cocktail   (&sort);                    break;
-		case 'D' : 	sort = origin; sample_sort_selection  (&sort);                    break;
-		case 'E' : 	sort = origin; sample_sort_insertion  (&sort);                    break;
-		case 'F' : 	sort = origin; sample_sort_shell      (&sort);                    break;
-		case 'G' : 	sort = origin; sample_sort_comb       (&sort);                    break;
-		case 'H' : 	sort = origin; sample_sort_merge      (&sort, 0, SAMPLE_SIZE-1);  break;
-		case 'I' : 	sort = origin; sample_sort_heap       (&sort);                    break;
-		case 'J' : 	sort = origin; sample_sort_count      (&sort);                    break; 
-		case 'K' : 	sort = origin; sample_sort_quick      (&sort, 0, SAMPLE_SIZE-1);  break;
-		case 'L' : 	sort = origin; sample_sort_radix      (&sort);					  break;
-		case 'M' : 	sort = origin; sample_sort_circle     (&sort);					  break;
+		default  :	sample_animate(algorithm_by_key(choice), &origin, &sort);	break;
 
 		case 'N' : 	title("CURRENT SORT SAMPLES"); sample_show(&origin, -1, -1, -1);  break;
 		case 'O' : 	if (sample_generate(&origin)) {
@@ -483,8 +648,11 @@ void app_exec() {
 		case 'X' :
 		case 'Q' : 	done = 1; break;
 		}
-		if (choice >= 'A' && choice <= 'P') waitkey();
+		if (choice != 'Q' && choice != 'X') waitkey();
 	}
+
+	sample_free(&sort);
+	sample_free(&origin);
 }
 
 void app_close() {
@@ -532,6 +700,239 @@ void app_params(int argc, char ** argv) {
 					exit(1);
 				}
 			}
+			else if(strcmp(argv[i], "--bench") == 0 || strcmp(argv[i], "-b") == 0) {
+				BENCH_MODE = true;
+			}
+			else if(strcmp(argv[i], "--size") == 0 || strcmp(argv[i], "-n") == 0) {
+				char * end;
+				double size = (i + 1 < argc) ? strtod(argv[i+1], &end) : 0;
+				if (i + 1 >= argc || *end != '\0' || size != (double)(long long) size) {
+					fprintf(stderr, "Error: --size/-n requires an integer value\n");
+					fprintf(stderr, "Example: sortvis --bench --size 1e6\n");
+					exit(1);
+				}
+				if (size < SAMPLE_SIZE_MIN || size > SAMPLE_SIZE_MAX) {
+					fprintf(stderr, "Error: Size must be between %d and %d (got %s)\n",
+							SAMPLE_SIZE_MIN, SAMPLE_SIZE_MAX, argv[i+1]);
+					exit(1);
+				}
+				SAMPLE_SIZE = (int) size;
+				i++;
+			}
+			else if(strcmp(argv[i], "--algs") == 0) {
+				if (i + 1 >= argc || !bench_select(argv[i+1])) {
+					fprintf(stderr, "Error: --algs requires a comma separated list of algorithms\n");
+					fprintf(stderr, "Example: sortvis --bench --algs merge,heap,quick\n");
+					exit(1);
+				}
+				i++;
+			}
+			else if(strcmp(argv[i], "--dist") == 0) {
+				if (i + 1 >= argc || !gen_select(argv[i+1])) {
+					fprintf(stderr, "Error: --dist requires a comma separated list of distributions\n");
+					fprintf(stderr, "Example: sortvis --bench --dist random,few,zipf\n");
+					exit(1);
+				}
+				i++;
+			}
+			else if(strcmp(argv[i], "--seed") == 0) {
+				char * end;
+				if (i + 1 < argc) GEN_SEED = strtoull(argv[i+1], &end, 0);
+				if (i + 1 >= argc || end == argv[i+1] || *end != '\0') {
+					fprintf(stderr, "Error: --seed requires an unsigned integer\n");
+					fprintf(stderr, "Example: sortvis --bench --seed 42\n");
+					exit(1);
+				}
+				GEN_SEEDED = true;
+				i++;
+			}
+			else if(strcmp(argv[i], "--repeat") == 0 || strcmp(argv[i], "--warmup") == 0) {
+				bool repeat = strcmp(argv[i], "--repeat") == 0;
+				int n;
+				if (i + 1 >= argc || sscanf(argv[i+1], "%d", &n) != 1 || n < repeat || n > BENCH_REPEAT_MAX) {
+					fprintf(stderr, "Error: %s requires a count between %d and %d\n", argv[i], repeat, BENCH_REPEAT_MAX);
+					fprintf(stderr, "Example: sortvis --bench --repeat 11 --warmup 2\n");
+					exit(1);
+				}
+				if (repeat) BENCH_REPEAT = n;
+				else BENCH_WARMUP = n;
+				i++;
+			}
+			else if(strcmp(argv[i], "--format") == 0) {
+				if (i + 1 >= argc || !bench_format(argv[i+1])) {
+					fprintf(stderr, "Error: --format requires tsv, csv or json\n");
+					fprintf(stderr, "Example: sortvis --bench --format json > baseline.json\n");
+					exit(1);
+				}
+				i++;
+			}
+			else if(strcmp(argv[i], "--compare") == 0) {
+				if (i + 1 >= argc) {
+					fprintf(stderr, "Error: --compare requires a table written by --format json\n");
+					fprintf(stderr, "Example: sortvis --bench --repeat 11 --compare baseline.json\n");
+					exit(1);
+				}
+				BENCH_COMPARE = argv[i+1];
+				BENCH_MODE = true;
+				i++;
+			}
+			else if(strcmp(argv[i], "--pin") == 0) {
+				unsigned long mask[CPU_PIN_MAX / (8 * sizeof(long))];
+				if (i + 1 >= argc || !cpu_list(argv[i+1], mask)) {
+					fprintf(stderr, "Error: --pin requires a list of cpus below %d\n", CPU_PIN_MAX);
+					fprintf(stderr, "Example: sortvis --bench --pin 0,2-3\n");
+					exit(1);
+				}
+				if (!cpu_pin(mask)) fprintf(stderr, "Note: cannot pin to cpus %s, running unpinned\n", argv[i+1]);
+				i++;
+			}
+			else if(strcmp(argv[i], "--perturb") == 0) {
+				int k;
+				if (i + 1 >= argc || sscanf(argv[i+1], "%d", &k) != 1 || k < 0 || k > 100) {
+					fprintf(stderr, "Error: --perturb requires a percentage between 0 and 100\n");
+					fprintf(stderr, "Example: sortvis --bench --dist nearly --perturb 1\n");
+					exit(1);
+				}
+				GEN_PERTURB = k;
+				i++;
+			}
+			else if(strcmp(argv[i], "--no-huge-pages") == 0) {
+				USE_HUGE_PAGES = false;
+			}
+			else if(strcmp(argv[i], "--full-redraw") == 0) {
+				DIFF_RENDERING = false;
+			}
+			else if(strcmp(argv[i], "--bench-render") == 0) {
+				BENCH_RENDER = true;
+			}
+			else if(strcmp(argv[i], "--bench-threads") == 0) {
+				BENCH_THREADS = true;
+			}
+			else if(strcmp(argv[i], "--threads") == 0 || strcmp(argv[i], "-t") == 0) {
+				int threads;
+				if (i + 1 >= argc || sscanf(argv[i+1], "%d", &threads) != 1 ||
+					threads < 1 || threads > POOL_MAX_THREADS) {
+					fprintf(stderr, "Error: --threads requires a count between 1 and %d\n", POOL_MAX_THREADS);
+					fprintf(stderr, "Example: sortvis --bench-threads --threads 8 -n 1e7\n");
+					exit(1);
+				}
+				THREADS = threads;
+				i++;
+			}
+			else if(strcmp(argv[i], "--bench-simd") == 0) {
+				BENCH_SIMD = true;
+			}
+			else if(strcmp(argv[i], "--simd") == 0) {
+				SIMD_CHOICE = (i + 1 < argc) ? argv[i+1] : "";
+				if (!net_select()) {
+					fprintf(stderr, "Error: --simd requires scalar, sse4.1, avx2 or off, supported by this cpu\n");
+					fprintf(stderr, "Example: sortvis --bench --simd scalar --algs quick,merge\n");
+					exit(1);
+				}
+				i++;
+			}
+			else if(strcmp(argv[i], "--heap-arity") == 0) {
+				int arity;
+				if (i + 1 >= argc || sscanf(argv[i+1], "%d", &arity) != 1 ||
+					(arity != 2 && arity != 4 && arity != 8)) {
+					fprintf(stderr, "Error: --heap-arity requires 2, 4 or 8\n");
+					fprintf(stderr, "Example: sortvis --bench --heap-arity 8 --algs dheap\n");
+					exit(1);
+				}
+				HEAP_ARITY = arity;
+				i++;
+			}
+			else if(strcmp(argv[i], "--bench-heap") == 0) {
+				BENCH_HEAP = true;
+			}
+			else if(strcmp(argv[i], "--perf") == 0) {
+				PERF_MODE = true;
+			}
+			else if(strcmp(argv[i], "--locality") == 0) {
+				LOCALITY_MODE = true;
+			}
+			else if(strcmp(argv[i], "--cache") == 0) {
+				CACHE_MODE = true;
+			}
+			else if(strcmp(argv[i], "--cache-levels") == 0) {
+				if (i + 1 >= argc || !cache_levels(argv[i+1])) {
+					fprintf(stderr, "Error: --cache-levels requires 1 to %d comma separated size/ways pairs\n", CACHE_LEVEL_MAX);
+					fprintf(stderr, "Example: sortvis --bench --cache-levels 48K/12,2M/16,96M/12\n");
+					exit(1);
+				}
+				CACHE_MODE = true;
+				i++;
+			}
+			else if(strcmp(argv[i], "--cache-line") == 0) {
+				if (i + 1 >= argc || sscanf(argv[i+1], "%d", &CACHE_LINE_BYTES) != 1) CACHE_LINE_BYTES = 0;
+				CACHE_MODE = true;
+				i++;
+			}
+			else if(strcmp(argv[i], "--bench-records") == 0) {
+				BENCH_RECORDS = true;
+			}
+			else if(strcmp(argv[i], "--bench-block") == 0) {
+				BENCH_BLOCK = true;
+			}
+			else if(strcmp(argv[i], "--bench-radix") == 0) {
+				BENCH_RADIX = true;
+			}
+			else if(strcmp(argv[i], "--bench-sweep") == 0) {
+				BENCH_SWEEP = true;
+			}
+			else if(strcmp(argv[i], "--sweep") == 0) {
+				if (i + 1 >= argc || !bench_sweep_range(argv[i+1])) {
+					fprintf(stderr, "Error: --sweep requires two powers of two between 5 and 29\n");
+					fprintf(stderr, "Example: sortvis --bench-sweep --sweep 5-16 --algs insertion,quick\n");
+					exit(1);
+				}
+				BENCH_SWEEP = true;
+				i++;
+			}
+			else if(strcmp(argv[i], "--sizes") == 0) {
+				if (i + 1 >= argc || !bench_sizes(argv[i+1])) {
+					fprintf(stderr, "Error: --sizes requires comma separated counts between %d and %d\n",
+							SAMPLE_SIZE_MIN, SAMPLE_SIZE_MAX);
+					fprintf(stderr, "Example: sortvis --bench-heap --sizes 1e5,1e6\n");
+					exit(1);
+				}
+				i++;
+			}
+			else if(strcmp(argv[i], "--duration") == 0) {
+				char * unit = NULL;
+				double t = (i + 1 < argc) ? strtod(argv[i+1], &unit) : 0;
+				if (unit && strcmp(unit, "ms") == 0) ;
+				else if (unit && (*unit == '\0' || strcmp(unit, "s") == 0)) t *= 1000;
+				else if (unit && strcmp(unit, "m") == 0) t *= 60000;
+				else t = 0;
+				if (t <= 0 || t > 86400000) {
+					fprintf(stderr, "Error: --duration requires a time such as 20s, 1.5m or 800ms\n");
+					fprintf(stderr, "Example: sortvis --duration 20s\n");
+					exit(1);
+				}
+				DURATION_MS = t;
+				i++;
+			}
+			else if(strcmp(argv[i], "--fps") == 0) {
+				int fps;
+				if (i + 1 >= argc || sscanf(argv[i+1], "%d", &fps) != 1 || fps < 0 || fps > 1000) {
+					fprintf(stderr, "Error: --fps requires a frame rate between 0 and 1000\n");
+					fprintf(stderr, "Example: sortvis --fps 30 -n 1e6\n");
+					exit(1);
+				}
+				LIVE_FPS = fps;
+				i++;
+			}
+			else if(strcmp(argv[i], "--record") == 0 || strcmp(argv[i], "--replay") == 0) {
+				if (i + 1 >= argc) {
+					fprintf(stderr, "Error: %s requires a file name\n", argv[i]);
+					fprintf(stderr, "Example: sortvis --record quick.trace --algs quick -n 1e6\n");
+					exit(1);
+				}
+				if (strcmp(argv[i], "--record") == 0) RECORD_FILE = argv[i+1];
+				else REPLAY_FILE = argv[i+1];
+				i++;
+			}
 			else {
 				fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
 				fprintf(stderr, "Use --help for usage information\n");
@@ -539,6 +940,30 @@ void app_params(int argc, char ** argv) {
 			}
 		}
 	}
+	if (CACHE_MODE && !cache_valid()) {
+		fprintf(stderr, "Error: The cache line must be a power of two that splits every level into whole sets\n");
+		fprintf(stderr, "Example: sortvis --cache --cache-line 128 -n 1e4\n");
+		exit(1);
+	}
+
+	/* headless runs never touch the terminal */
+	if (BENCH_RENDER) exit(bench_render());
+	if (BENCH_THREADS) exit(bench_threads());
+	if (BENCH_SIMD) exit(bench_simd());
+	if (BENCH_HEAP) exit(bench_heap());
+	if (BENCH_RECORDS) exit(bench_records());
+	if (BENCH_BLOCK) exit(bench_block());
+	if (BENCH_RADIX) exit(bench_radix());
+	if (BENCH_SWEEP) exit(bench_sweep());
+	if (BENCH_MODE) exit(bench_run());
+	if (RECORD_FILE) exit(trace_record());
+	if (REPLAY_FILE) {
+		int code;
+		app_init();
+		code = trace_play();
+		app_close();
+		exit(code);
+	}
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,343 @@
+#ifndef __SORTVIS_TRACE__
+#define __SORTVIS_TRACE__
+
+/*---- TRACE FILES -------------------------*/
+/* A trace is the initial samples plus the event stream of one sort run.
+   Layout, all integers little-endian:
+
+	header	"SVTR", version, n, max, algorithm key, events per block, total events
+	blocks	u32 payload bytes, u32 item count, payload
+			first the samples (zigzag varint deltas), then the events,
+			ended by an empty block
+
+   Every block restarts its delta state, so playback decodes one block at a
+   time straight from the mapping and hands finished pages back. An event
+   is its op byte, flags in the high nibble, then varint operands. Version
+   2 added EV_ACCESS, the scratch flags and the slot of a move; version 1
+   traces still play. */
+
+#define	TRACE_MAGIC			"SVTR"
+#define	TRACE_VERSION		2
+#define	TRACE_HEADER		32					/* bytes before the first block */
+#define	TRACE_BLOCK_EVENTS	(1 << 16)			/* items per block */
+#define	TRACE_ITEM_MAX		32					/* worst case encoded bytes per item */
+
+const char * RECORD_FILE = NULL;	/* --record: trace written headless */
+const char * REPLAY_FILE = NULL;	/* --replay: trace played on the terminal */
+
+typedef struct trace_writer {
+	FILE *			f;
+	unsigned char *	buf;			/* one encoded block */
+	long long		events;
+	long long		bytes;
+} TRACE_WRITER;
+
+/*---- encoding helpers ----*/
+static void put_u32(unsigned char * p, unsigned v) {
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+static unsigned get_u32(const unsigned char * p) {
+	return p[0] | (unsigned) p[1] << 8 | (unsigned) p[2] << 16 | (unsigned) p[3] << 24;
+}
+
+static unsigned char * put_varint(unsigned char * p, long long v) {
+	unsigned long long z = ((unsigned long long) v << 1) ^ (unsigned long long)(v >> 63);	/* zigzag */
+	while (z >= 0x80) { *p++ = (unsigned char)(z | 0x80); z >>= 7; }
+	*p++ = (unsigned char) z;
+	return p;
+}
+
+/* Returns NULL when the varint runs past end */
+static const unsigned char * get_varint(const unsigned char * p, const unsigned char * end, long long * v) {
+	unsigned long long z = 0;
+	for (int shift = 0; p < end && shift < 64; shift += 7) {
+		unsigned char b = *p++;
+		z |= (unsigned long long)(b & 0x7F) << shift;
+		if (!(b & 0x80)) {
+			*v = (long long)(z >> 1) ^ -(long long)(z & 1);
+			return p;
+		}
+	}
+	return NULL;
+}
+
+/*---- recording ----*/
+static int trace_flags(int op, int c) {
+	/* the flags an op carries in the high nibble of its byte */
+	switch (op) {
+	case EV_COMPARE:	return c & EV_IN_SCRATCH;
+	case EV_WRITE:		return c & (EV_COUNTED | EV_IN_SCRATCH);
+	case EV_ACCESS:		return c & (EV_STORE | EV_IN_SCRATCH);
+	}
+	return 0;
+}
+
+static void trace_block(TRACE_WRITER * w, unsigned char * end, size_t count) {
+	size_t bytes = end - w->buf - 8;
+	put_u32(w->buf, (unsigned) bytes);
+	put_u32(w->buf + 4, (unsigned) count);
+	fwrite(w->buf, 1, bytes + 8, w->f);
+	w->bytes += bytes + 8;
+}
+
+/* EVENTS.flush: encodes the recorded list as one block */
+void trace_flush(EVENTS * ev) {
+	TRACE_WRITER * w = (TRACE_WRITER *) ev->sink;
+	unsigned char * p = w->buf + 8;
+	long long prev = 0;
+	for (size_t i = 0; i < ev->count; i++) {
+		const EVENT * e = &ev->list[i];
+		*p++ = (unsigned char)(e->op | trace_flags(e->op, e->c) << 4);
+		bool raw = (e->op == EV_STEAL || e->op == EV_DEPTH || e->op == EV_AUX || e->op == EV_COPY);
+		p = put_varint(p, raw ? e->a : (long long) e->a - prev);
+		switch (e->op) {
+		case EV_COMPARE: case EV_SWAP: case EV_BOUNDS:
+			p = put_varint(p, (long long) e->b - e->a);
+			break;
+		case EV_WRITE: case EV_MOVE:
+			p = put_varint(p, e->b);
+			break;
+		case EV_STEP: case EV_FLASH: case EV_FRAME:
+			p = put_varint(p, (long long) e->b - e->a);
+			p = put_varint(p, (long long) e->c - e->a);
+			break;
+		case EV_REGION:
+			p = put_varint(p, (long long) e->b - e->a);
+			p = put_varint(p, e->c);
+			break;
+		}
+		if (raw) continue;				/* a is a thread or a count, not an index */
+		prev = e->a;
+	}
+	trace_block(w, p, ev->count);
+	w->events += ev->count;
+	ev->count = 0;
+}
+
+static void trace_samples(TRACE_WRITER * w, const SAMPLES * s) {
+	for (int i = 0; i < SAMPLE_SIZE; i += TRACE_BLOCK_EVENTS) {
+		int n = (SAMPLE_SIZE - i < TRACE_BLOCK_EVENTS) ? SAMPLE_SIZE - i : TRACE_BLOCK_EVENTS;
+		unsigned char * p = w->buf + 8;
+		long long prev = 0;
+		for (int k = i; k < i + n; k++) {
+			p = put_varint(p, (long long) s->data[k] - prev);
+			prev = s->data[k];
+		}
+		trace_block(w, p, n);
+	}
+}
+
+/* Sorts the first --dist samples with the first algorithm picked by --algs and
+   writes the run to RECORD_FILE. Returns the process exit code. */
+int trace_record() {
+	SAMPLES s;
+	unsigned char header[TRACE_HEADER] = TRACE_MAGIC;
+	const ALGORITHM * alg = NULL;
+	for (int a = 0; a < ALGORITHM_COUNT && !alg; a++)
+		if (BENCH_PICKED[a]) alg = &ALGORITHMS[a];
+	if (!alg) {
+		fprintf(stderr, "Error: --record needs an algorithm, e.g. --algs quick\n");
+		return 1;
+	}
+
+	TRACE_WRITER w = { fopen(RECORD_FILE, "wb"), NULL, 0, 0 };
+	if (!w.f) {
+		fprintf(stderr, "Error: Cannot create trace file '%s'\n", RECORD_FILE);
+		return 1;
+	}
+	w.buf = (unsigned char *) malloc(8 + (size_t) TRACE_BLOCK_EVENTS * TRACE_ITEM_MAX);
+	EVENTS ev = { (EVENT *) malloc(TRACE_BLOCK_EVENTS * sizeof(EVENT)), 0, TRACE_BLOCK_EVENTS, trace_flush, &w };
+	if (!w.buf || !ev.list || !sample_alloc(&s)) die(1, "Error: Out of memory for trace recording\n");
+
+	ENABLE_VISUALIZATION = false;
+	sample_generate_first(&s);
+
+	put_u32(header + 4, TRACE_VERSION);
+	put_u32(header + 8, SAMPLE_SIZE);
+	put_u32(header + 12, s.max);
+	put_u32(header + 16, (unsigned char) alg->key);
+	put_u32(header + 20, TRACE_BLOCK_EVENTS);
+	fwrite(header, 1, TRACE_HEADER, w.f);
+	w.bytes = TRACE_HEADER;
+	trace_samples(&w, &s);
+
+	double start = mstime();
+	sample_events = &ev;
+	alg->sort(&s);
+	sample_events = NULL;
+	if (ev.count) trace_flush(&ev);
+	trace_block(&w, w.buf + 8, 0);				/* end of trace */
+	double elapsed = mstime() - start;
+
+	/* the total is only known now, patch it in when the file is seekable */
+	if (fseek(w.f, 24, SEEK_SET) == 0) {
+		put_u32(header + 24, (unsigned)(w.events & 0xFFFFFFFFu));
+		put_u32(header + 28, (unsigned)(w.events >> 32));
+		fwrite(header + 24, 1, 8, w.f);
+	}
+	int failed = ferror(w.f) | fclose(w.f);
+
+	fprintf(stderr, "%s\t%d samples\t%lld events\t%lld bytes\t%.3f ms\n",
+			alg->name, SAMPLE_SIZE, w.events, w.bytes, elapsed);
+	if (failed) fprintf(stderr, "Error: Writing trace file '%s' failed\n", RECORD_FILE);
+
+	free(ev.list);
+	free(w.buf);
+	sample_free(&s);
+	return failed ? 1 : 0;
+}
+
+/*---- playback ----*/
+typedef struct trace_reader {
+	MAPPING			map;
+	size_t			pos;			/* offset of the next block */
+	const unsigned char * payload;	/* current block */
+	const unsigned char * end;
+	unsigned		count;
+	unsigned		version;
+} TRACE_READER;
+
+static bool trace_next(TRACE_READER * r) {
+	if (r->pos + 8 > r->map.size) return false;
+	unsigned bytes = get_u32(r->map.data + r->pos);
+	if (bytes > r->map.size - r->pos - 8) return false;
+	r->count   = get_u32(r->map.data + r->pos + 4);
+	r->payload = r->map.data + r->pos + 8;
+	r->end     = r->payload + bytes;
+	file_release(&r->map, r->pos);				/* everything before is played */
+	r->pos    += 8 + bytes;
+	return true;
+}
+
+static bool trace_index(long long i, bool marker) {
+	/* markers may be -1 or one past the end, like the end of a heap, data
+	   accesses must be in range */
+	return marker ? i >= -1 && i <= SAMPLE_SIZE : i >= 0 && i < SAMPLE_SIZE;
+}
+
+/* Decodes a block of events; written values must lie in 1..max like the
+   samples, the renderer divides by max and indexes shades with them */
+static bool trace_decode(TRACE_READER * r, EVENT * list, int max) {
+	const unsigned char * p = r->payload;
+	long long prev = 0, a, b = 0, c = 0;
+	if (r->count > TRACE_BLOCK_EVENTS) return false;
+	for (unsigned i = 0; i < r->count; i++) {
+		if (p >= r->end) return false;
+		int op = *p & 0x0F, flag = *p++ >> 4;
+		if (op >= EV_COUNT || trace_flags(op, flag) != flag || !(p = get_varint(p, r->end, &a))) return false;
+		if (op == EV_STEAL || op == EV_DEPTH || op == EV_AUX || op == EV_COPY) {
+			if (a < 0 || (op == EV_STEAL ? a >= POOL_MAX_THREADS : a > 0x7FFFFFFF)) return false;
+			list[i].op = op;
+			list[i].a = (int) a;
+			list[i].b = list[i].c = 0;
+			continue;
+		}
+		a += prev;
+		b = 0;
+		c = flag;
+		switch (op) {
+		case EV_COMPARE: case EV_SWAP: case EV_BOUNDS:
+			if (!(p = get_varint(p, r->end, &b))) return false;
+			b += a;
+			break;
+		case EV_WRITE:
+			if (!(p = get_varint(p, r->end, &b)) || b < 1 || b > max) return false;
+			break;
+		case EV_MOVE:
+			if (r->version < 2) b = -1;		/* the slot was not recorded */
+			else if (!(p = get_varint(p, r->end, &b))) return false;
+			break;
+		case EV_STEP: case EV_FLASH: case EV_FRAME:
+			if (!(p = get_varint(p, r->end, &b)) || !(p = get_varint(p, r->end, &c))) return false;
+			b += a;
+			c += a;
+			break;
+		case EV_REGION:
+			if (!(p = get_varint(p, r->end, &b)) || !(p = get_varint(p, r->end, &c))) return false;
+			b += a;
+			if (c < 0 || c > 0x7FFFFFFF) return false;
+			break;
+		}
+		bool marker = (op != EV_SWAP && op != EV_WRITE && op != EV_ACCESS);
+		if (!trace_index(a, marker) || (op != EV_WRITE && !trace_index(b, marker)) ||
+			(op != EV_REGION && !trace_index(c, true)))
+			return false;
+		list[i].op = op;
+		list[i].a = (int) a;
+		list[i].b = (int) b;
+		list[i].c = (int) c;
+		prev = a;
+	}
+	return true;
+}
+
+/* Plays REPLAY_FILE on the initialized terminal. Returns the exit code. */
+int trace_play() {
+	TRACE_READER r;
+	SAMPLES s = { NULL };
+	EVENT * list = NULL;
+	const char * error = NULL;
+	char name[64];
+
+	memset(&r, 0, sizeof(r));
+	r.pos = TRACE_HEADER;
+	if (!file_map(&r.map, REPLAY_FILE)) {
+		fprintf(stderr, "Error: Cannot open trace file '%s'\n", REPLAY_FILE);
+		return 1;
+	}
+	const unsigned char * h = r.map.data;
+	const ALGORITHM * alg = (r.map.size >= TRACE_HEADER) ? algorithm_by_key((char) get_u32(h + 16)) : NULL;
+	if (!alg || memcmp(h, TRACE_MAGIC, 4) != 0 || get_u32(h + 4) < 1 || get_u32(h + 4) > TRACE_VERSION ||
+		get_u32(h + 8) < SAMPLE_SIZE_MIN || get_u32(h + 8) > SAMPLE_SIZE_MAX ||
+		get_u32(h + 12) < 1 || get_u32(h + 12) > 0x7FFFFFFF) {
+		fprintf(stderr, "Error: '%s' is not a sortvis trace\n", REPLAY_FILE);
+		file_unmap(&r.map);
+		return 1;
+	}
+
+	r.version = get_u32(h + 4);
+	SAMPLE_SIZE = (int) get_u32(h + 8);
+	list = (EVENT *) malloc(TRACE_BLOCK_EVENTS * sizeof(EVENT));
+	if (!list || !sample_alloc(&s)) die(1, "Error: Out of memory for trace playback\n");
+	s.max = (int) get_u32(h + 12);
+
+	/* initial samples */
+	for (int i = 0; i < SAMPLE_SIZE && !error; ) {
+		const unsigned char * p;
+		long long prev = 0, v;
+		if (!trace_next(&r) || r.count == 0 || r.count > (unsigned)(SAMPLE_SIZE - i)) { error = "samples"; break; }
+		p = r.payload;
+		for (unsigned k = 0; k < r.count; k++, i++) {
+			if (!(p = get_varint(p, r.end, &v))) { error = "samples"; break; }
+			prev += v;
+			if (prev < 1 || prev > s.max) { error = "samples"; break; }
+			s.data[i] = (int) prev;
+		}
+	}
+
+	/* operations, one block at a time */
+	snprintf(name, sizeof(name), "%s", alg->label);
+	for (char * c = name; *c; c++) *c = toupper(*c & 0xFF);
+	clear();
+	title(name);
+	cache_reset();
+	sample_show(&s, -1, -1, -1);
+	while (!error) {
+		if (!trace_next(&r) || !trace_decode(&r, list, s.max)) { error = "events"; break; }
+		if (r.count == 0) break;				/* end of trace */
+		for (unsigned i = 0; i < r.count; i++)
+			event_apply(&s, &list[i]);
+	}
+	sample_show(&s, -1, -1, -1);
+
+	if (error) fprintf(stderr, "\nError: Trace '%s' is damaged (%s)\n", REPLAY_FILE, error);
+	else waitkey();
+
+	free(list);
+	sample_free(&s);
+	file_unmap(&r.map);
+	return error ? 1 : 0;
+}
+
+#endif
@@ -17,6 +17,8 @@
 #define	VT_CURSORHIDE	"\x1B[?25l"
 #define	VT_DEFAULTATTR	"\x1B[0m"
 #define	VT_CURSORHOME	"\x1B[H"
+#define	VT_CURSORPOS	"\x1B[%d;%dH"		/* printf format: row, column (1-based) */
+#define	VT_ERASELINE	"\x1B[K"
 #define VT_RESET		VT_DEFAULTATTR
 
 #ifdef _WIN32